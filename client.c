@@ -1,4 +1,5 @@
 /* client.c */
+#define _GNU_SOURCE  // Für sendmmsg() und recvmmsg()
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,24 +7,685 @@
 #include <sys/socket.h>
 #include <unistd.h>
 #include <time.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/random.h>
+#include <poll.h>
+#include <linux/errqueue.h>
+#include <netinet/udp.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include "protocol.h"
+#include "fec.h"
 
-#define BUF_SIZE 1024             // Maximale Größe eines Datenpakets
-#define DEFAULT_INTERVAL 300000   // Zeitintervall für das Senden von Paketen in Mikrosekunden (300 ms)
-#define MAX_WINDOW_SIZE 10        // Maximale Fenstergröße
-#define MAX_SEQ_NUM 1000          // Maximale Anzahl an Paketen
+#define BUF_SIZE MAX_PAYLOAD      // Maximale Größe der Nutzdaten eines Datenpakets
+#define DEFAULT_INTERVAL 300000   // Anfänglicher Retransmissions-Timeout in Mikrosekunden (300 ms)
+#define MIN_RTO 20000             // Untergrenze des Retransmissions-Timeouts in Mikrosekunden (20 ms)
+#define MAX_RTO 10000000          // Obergrenze des Retransmissions-Timeouts in Mikrosekunden (10 s)
+#define MAX_WINDOW_SIZE 1024      // Maximale Fenstergröße
+#define WHEEL_SLOTS 256           // Anzahl der Slots im Timer-Rad
+#define WHEEL_TICK 10000          // Auflösung eines Slots im Timer-Rad in Mikrosekunden (10 ms)
+#define SEND_BATCH 64             // Maximale Anzahl an Paketen pro sendmmsg()-Aufruf
+#define RECV_BATCH 64             // Maximale Anzahl an Rückmeldungen pro recvmmsg()-Aufruf
+#define MAX_EVENTS 4              // Maximale Anzahl an Ereignissen pro epoll_wait()-Aufruf
+#define MAX_RECEIVERS 64          // Maximale Anzahl an Empfängern (eine Bitmaske pro Paket)
+#define REGISTRATION_TIME 200000  // Wartezeit auf weitere HELLO ACKs nach dem ersten in Mikrosekunden (200 ms)
+#define RECEIVER_TIMEOUT 3000000  // Empfänger ohne Rückmeldung seit dieser Zeit gelten als ausgefallen (3 s)
+#define QUORUM_LAG_WINDOWS 4      // Im Quorum-Modus hält der Ringpuffer so viele Fenster für zurückliegende Empfänger
+#define INITIAL_CWND 10           // Anfängliches Überlastfenster in Paketen (RFC 6928)
+#define MIN_CWND 2                // Untergrenze des Überlastfensters in Paketen
+#define PACING_GAIN_SS 2.0        // Pacing-Faktor auf cwnd / SRTT im Slow Start
+#define PACING_GAIN_CA 1.2        // Pacing-Faktor auf cwnd / SRTT in der Congestion Avoidance
+#define PACING_BURST 4            // Der Token-Bucket fasst höchstens so viele Pakete
+#define ZC_TRACK 4096             // Maximale Anzahl ausstehender Zero-Copy-Pakete (Zweierpotenz)
+#define ZC_DRAIN_TIMEOUT 1000     // Wartezeit auf ausstehende Zero-Copy-Abschlüsse am Ende in Millisekunden
+#define ZC_SLOT_TIMEOUT 1000000   // Höchstens so lange wartet ein Slot auf seine Abschlussmeldung (1 s)
 
-char sent_packets[MAX_SEQ_NUM][BUF_SIZE];  // Puffer für gesendete Pakete
-int packet_lengths[MAX_SEQ_NUM];          // Längen der gesendeten Pakete
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+#define GSO_MAX_SEGMENTS 64       // Maximale Anzahl an Paketen pro Superdatagramm (UDP_MAX_SEGMENTS)
+#define GSO_MAX_BYTES (65535 - 8) // Größte UDP-Nutzlast eines IPv6-Datagramms ohne Jumbogramm
+
+#define STREAM_STAGING_SIZE (1 << 18)  // Größe des Zwischenpuffers für die Eingabe von stdin (256 KiB)
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+int binary_mode = 0;                      // Datei in Blöcken fester Größe statt zeilenweise senden
+int chunk_size = DEFAULT_CHUNK_SIZE;      // Größe der Nutzdaten im Binärmodus
+int max_line = BUF_SIZE - 1;              // Größte Nutzdatenlänge einer Textzeile
+int fec_data = 0;                         // n: Datenpakete pro FEC-Block (0 = ohne Vorwärtsfehlerkorrektur)
+int fec_parity = 0;                       // k: Paritätspakete pro FEC-Block
+uint32_t initial_seq = 0;                 // Erste Sequenznummer, wird dem Empfänger im HELLO mitgeteilt
+uint32_t session_id = 0;                  // Zufällige Kennung dieser Übertragung, steht in jedem Paketkopf
+int quorum = 0;                           // Anzahl der Empfänger, die jedes Paket bestätigen müssen (0 = alle)
+int expected_receivers = 0;               // Registrierung nach so vielen HELLO ACKs beenden (0 = REGISTRATION_TIME abwarten)
+
+// Ein beim Verbindungsaufbau registrierter Empfänger (Absender eines HELLO ACK)
+struct receiver {
+    struct sockaddr_in6 addr;             // Adresse des Empfängers
+    char name[INET6_ADDRSTRLEN + 8];      // Adresse und Port als Text für Ausgaben
+    uint32_t next_expected;               // Lückenlos bis vor diese Sequenznummer bestätigt
+    long long last_heard;                 // Zeitpunkt der letzten Rückmeldung in Mikrosekunden
+    long long waiting_since;              // Erste Übertragung nach der letzten Rückmeldung, 0 wenn keine
+    int alive;                            // Gibt an, ob der Empfänger noch an der Übertragung teilnimmt
+    int closed;                           // Gibt an, ob das CLOSE ACK des Empfängers eingetroffen ist
+};
+
+struct receiver receivers[MAX_RECEIVERS];
+int receiver_count = 0;                   // Anzahl der registrierten Empfänger
+uint64_t alive_mask = 0;                  // Bitmaske der noch teilnehmenden Empfänger
+long long last_transmit = 0;              // Zeitpunkt der letzten Übertragung von Datenpaketen in Mikrosekunden
+
+// Eingabedatei, per mmap in den Speicher eingeblendet
+const char *input_data = NULL;            // Anfang der eingeblendeten Datei
+size_t input_size = 0;                    // Größe der Datei in Bytes
+size_t input_offset = 0;                  // Position der nächsten noch nicht gesendeten Nutzdaten
+
+// Eingabe von stdin ("-"): gelesen wird in einen Zwischenpuffer, aus dem jedes Paket in den Puffer
+// seines Ringpuffer-Slots kopiert wird. Der Speicherbedarf ist so unabhängig von der Eingabelänge
+// durch das Fenster begrenzt; ein Slot-Puffer wird erst wiederverwendet, wenn sein Paket bestätigt ist.
+int stream_input = 0;                     // Eingabe kommt von stdin statt aus einer Datei
+int stream_pollable = 0;                  // stdin ist nicht blockierend und per epoll beobachtbar (Pipe, Terminal)
+int stream_flags = 0;                     // Ursprüngliche Dateistatus-Flags von stdin
+int stream_eof = 0;                       // stdin hat das Dateiende geliefert
+char *stream_staging = NULL;              // Zwischenpuffer für gelesene, noch nicht verpackte Daten
+size_t staged_start = 0;                  // Beginn der noch nicht verpackten Daten im Zwischenpuffer
+size_t staged_end = 0;                    // Ende der gelesenen Daten im Zwischenpuffer
+char *stream_slots = NULL;                // Nutzdatenpuffer pro Ringpuffer-Slot
+size_t stream_slot_size = 0;              // Größe eines Nutzdatenpuffers (größte Nutzdatenlänge)
+
+// RTT-Schätzung nach Jacobson/Karels (RFC 6298)
+long long srtt = 0;                       // Geglättete Round-Trip-Time in Mikrosekunden
+long long rttvar = 0;                     // Schwankung der Round-Trip-Time in Mikrosekunden
+long long rto = DEFAULT_INTERVAL;         // Aktueller Retransmissions-Timeout in Mikrosekunden
+int rtt_measured = 0;                     // Gibt an, ob bereits eine Messung vorliegt
+long long last_backoff = 0;               // Zeitpunkt der letzten Verdopplung des RTO
+
+// Überlastkontrolle (AIMD) und Pacing über einen Token-Bucket
+double cwnd = INITIAL_CWND;               // Überlastfenster in Paketen
+double ssthresh = MAX_WINDOW_SIZE;        // Slow-Start-Schwelle in Paketen
+int max_window = MAX_WINDOW_SIZE;         // Fenstergröße aus der Kommandozeile, Obergrenze für cwnd
+uint32_t recovery_seq = 0;                // Verluste vor dieser Sequenznummer gehören zur letzten Verringerung
+long long max_rate = 0;                   // Obergrenze der Senderate in Bytes pro Sekunde (0 = unbegrenzt)
+double tokens = 0;                        // Guthaben des Token-Buckets in Bytes, negativ nach Vorgriff
+long long token_time = 0;                 // Zeitpunkt der letzten Auffüllung des Token-Buckets
+double average_packet = DEFAULT_CHUNK_SIZE + HEADER_SIZE;  // Gleitender Mittelwert der Paketgröße in Bytes
+
+// Zero-Copy-Versand (MSG_ZEROCOPY): der Kernel liest Kopf und Nutzdaten direkt aus dem Ringpuffer
+// und der eingeblendeten Datei. Jeder erfolgreich übergebenen Nachricht (mit GSO bis zu
+// GSO_MAX_SEGMENTS Pakete) vergibt er eine fortlaufende Nummer und meldet über die
+// Fehlerwarteschlange des Sockets, wann er die Seiten nicht mehr braucht.
+int zerocopy = 0;                         // Datenpakete mit MSG_ZEROCOPY senden (-z)
+uint32_t zc_next_id = 0;                  // Nummer, die der Kernel der nächsten Zero-Copy-Nachricht vergibt
+uint32_t zc_log[ZC_TRACK];                // Sequenznummern der übergebenen Pakete in Übergabereihenfolge
+uint32_t zc_log_next = 0;                 // Nächste Position in zc_log (läuft über)
+uint32_t zc_first[ZC_TRACK];              // Erste Position in zc_log pro Nachricht, indiziert über id % ZC_TRACK
+int zc_count[ZC_TRACK];                   // Anzahl der Pakete pro Nachricht
+int zc_outstanding = 0;                   // Pakete mit noch nicht abgeschlossener Zero-Copy-Übertragung
+
+// Segmentierung durch den Kernel (UDP GSO): aufeinanderfolgende gleich große Datenpakete werden
+// als ein Superdatagramm übergeben und erst im Kernel bzw. von der Netzwerkkarte zerteilt
+int gso_enabled = 1;                      // Wird abgeschaltet, wenn der Kernel UDP_SEGMENT ablehnt
+int gso_verified = 0;                     // Ein Superdatagramm wurde bereits angenommen
+size_t gso_max_segment = GSO_MAX_BYTES;   // Größtes Paket, das nach der Segmentierung in die Pfad-MTU passt
+
+// Retransmissions-Timer einer Sequenznummer (Eintrag im Timer-Rad)
+struct retransmit_timer {
+    uint32_t seq_num;                     // Zugehörige Sequenznummer
+    int slot;                             // Slot, in dem der Timer eingehängt ist
+    int rounds;                           // Verbleibende Umdrehungen des Rades bis zum Ablauf
+    int armed;                            // Gibt an, ob der Timer aktiv ist
+    struct retransmit_timer *prev;        // Vorheriger Timer im selben Slot
+    struct retransmit_timer *next;        // Nächster Timer im selben Slot
+};
+
+struct retransmit_timer *wheel[WHEEL_SLOTS];  // Slots des Timer-Rads (doppelt verkettete Listen)
+int wheel_cursor = 0;                         // Aktueller Slot des Timer-Rads
+long long wheel_time = 0;                     // Zeitpunkt des aktuellen Slots in Mikrosekunden
+int armed_timers = 0;                         // Anzahl aktiver Timer
+
+// Eintrag im Retransmissionspuffer. Die Nutzdaten liegen in der eingeblendeten Datei,
+// gespeichert werden nur Kopf, Position und Zustand des Pakets.
+struct send_slot {
+    struct packet_header header;          // Kopf des gesendeten Pakets
+    const char *data;                     // Nutzdaten in der eingeblendeten Datei bzw. im Slot-Puffer (stdin)
+    int length;                           // Länge der Nutzdaten
+    uint64_t ack_mask;                    // Bitmaske der Empfänger, die das Paket bestätigt haben
+    int acked;                            // Gibt an, ob genug Empfänger bestätigt haben, um das Fenster zu verschieben
+    int rtt_sample_valid;                 // Gibt an, ob ein ACK eine eindeutige RTT-Messung liefert
+    long long send_time;                  // Zeitpunkt der letzten Übertragung in Mikrosekunden
+    long long resend_time;                // Zeitpunkt der letzten Wiederholung in Mikrosekunden, 0 wenn keine
+    int simulated_loss;                   // Letzte Übertragung wurde absichtlich verworfen (keine Überlast)
+    int zc_pending;                       // Ausstehende Zero-Copy-Übertragungen, bis dahin bleibt der Kopf unverändert
+    struct retransmit_timer timer;        // Retransmissions-Timer des Pakets
+};
+
+// Ringpuffer für gesendete Pakete, indiziert über seq_num & ring_mask. Die Kapazität ist
+// die nächste Zweierpotenz über der Fenstergröße, da nie mehr Pakete unbestätigt sind.
+// Mit Quorum fasst er mehrere Fenster, damit Empfänger hinter dem Quorum aufholen können.
+struct send_slot *send_ring = NULL;
+int ring_mask = 0;
+
+// Paritätspaket des aktuellen FEC-Blocks. Kopf, fec_header und XOR der Nutzdaten liegen
+// zusammenhängend im Speicher und werden mit einem iovec gesendet.
+struct parity_packet {
+    struct packet_header header;          // Paketkopf (seq_num = erste Sequenznummer des Blocks)
+    struct fec_header fec;                // Beschreibung der abgedeckten Datenpakete
+    uint8_t data[FEC_MAX_DATA_PAYLOAD];   // XOR der Nutzdaten, kürzere Pakete mit Nullen aufgefüllt
+    int data_len;                         // Längste bisher eingerechnete Nutzdatenlänge
+    uint16_t length_xor;                  // XOR der Nutzdatenlängen (Host-Byte-Reihenfolge)
+};
+
+struct parity_packet *parity_packets = NULL;  // fec_parity Paritätspakete des aktuellen Blocks
+uint32_t block_start = 0;                     // Erste Sequenznummer des aktuellen FEC-Blocks
+int block_fill = 0;                           // Bereits eingerechnete Datenpakete des aktuellen Blocks
+
+// Sendestapel: eingereihte Pakete werden gemeinsam mit einem sendmmsg()-Aufruf verschickt.
+// Jede Nachricht verweist mit zwei iovecs auf Kopf im Ringpuffer und Nutzdaten in der Datei.
+struct mmsghdr send_msgs[SEND_BATCH];
+struct iovec send_iovs[SEND_BATCH][2];
+uint32_t send_seqs[SEND_BATCH];           // Sequenznummer jeder eingereihten Nachricht
+int send_count = 0;
+int send_copy_only = 0;                   // Stapel enthält Pakete aus wiederverwendeten Puffern (Parität)
+
+// Tatsächlich an sendmmsg() übergebene Nachrichten: je ein Superdatagramm aus einem oder mehreren eingereihten Paketen
+struct mmsghdr gso_msgs[SEND_BATCH];
+char gso_control[SEND_BATCH][CMSG_SPACE(sizeof(uint16_t))];
+int gso_members[SEND_BATCH];              // Anzahl der eingereihten Pakete pro Superdatagramm
+
+// Vorab angelegte Empfangspuffer für Rückmeldungen, befüllt mit einem recvmmsg()-Aufruf
+char recv_buffers[RECV_BATCH][MAX_PACKET_SIZE];
+struct sockaddr_in6 recv_addrs[RECV_BATCH];
+struct iovec recv_iovs[RECV_BATCH];
+struct mmsghdr recv_msgs[RECV_BATCH];
 
 // Funktion zur Ausgabe der Nutzungsanleitung
 void usage() {
-    printf("Usage: client <file> <multicast_addr> <port> <window_size> <error_rate>\n");
+    printf("Usage: client [-b] [-s chunk_size] [-i initial_seq] [-n receivers] [-q quorum] [-e n:k] [-r rate] [-z] <file|-> <multicast_addr> <port> <window_size> <error_rate>\n");
+    printf("  file           File to send, - streams from stdin with memory bounded by the window\n");
+    printf("  -b             Send the file as binary chunks instead of text lines\n");
+    printf("  -s chunk_size  Payload bytes per chunk in binary mode (default %d, max %d)\n",
+           DEFAULT_CHUNK_SIZE, MAX_PAYLOAD);
+    printf("  -i initial_seq First sequence number (default 0, 32-bit with wraparound)\n");
+    printf("  -n receivers   Stop waiting for HELLO ACKs once this many receivers answered\n");
+    printf("  -q quorum      Receivers that must acknowledge a packet before the window moves (default all)\n");
+    printf("  -e n:k         Forward error correction: k XOR parity packets per block of n data packets\n");
+    printf("  -r rate        Maximum send rate in bit/s, suffixes k, M and G allowed (default unlimited)\n");
+    printf("  -z             Send data packets with MSG_ZEROCOPY (worthwhile for large chunks, see -s)\n");
     exit(EXIT_FAILURE);
 }
 
-// Funktion zum Lesen einer Zeile aus der Datei (Anwendungsschicht)
-int readFileLine(FILE *file, char *buffer, int buffer_size) {
-    return fgets(buffer, buffer_size, file) != NULL;  // Liest eine Zeile und gibt 1 zurück, wenn erfolgreich
+// Funktion zum Einblenden der Eingabedatei in den Speicher (Anwendungsschicht)
+void mapInputFile(const char *filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("open");
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        perror("fstat");
+        close(fd);
+        exit(EXIT_FAILURE);
+    }
+
+    input_size = (size_t)st.st_size;
+    input_offset = 0;
+
+    // Eine leere Datei kann nicht eingeblendet werden und wird als sofortiges Dateiende behandelt
+    if (input_size > 0) {
+        void *mapping = mmap(NULL, input_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            exit(EXIT_FAILURE);
+        }
+        madvise(mapping, input_size, MADV_SEQUENTIAL);  // Vorauslesen für sequentiellen Zugriff
+        input_data = mapping;
+    }
+
+    close(fd);  // Die Einblendung bleibt auch nach dem Schließen gültig
+}
+
+// Funktion zum Freigeben der eingeblendeten Eingabedatei
+void unmapInputFile() {
+    if (input_data) {
+        munmap((void *)input_data, input_size);
+        input_data = NULL;
+    }
+}
+
+// Funktion zum Wiederherstellen der ursprünglichen Flags von stdin. Die Dateibeschreibung teilt sich
+// stdin z. B. mit der aufrufenden Shell, daher läuft dies per atexit() auch bei jedem Abbruch mit exit().
+void restoreInputFlags() {
+    if (stream_pollable) {
+        fcntl(STDIN_FILENO, F_SETFL, stream_flags);
+    }
+}
+
+// Funktion zum Vorbereiten von stdin als Eingabe. Pipes und Terminals werden nicht blockierend
+// gelesen und per epoll beobachtet, damit ein langsamer Erzeuger ACKs und Timer nicht aufhält.
+// Eine umgeleitete reguläre Datei liefert immer sofort Daten und wird blockierend gelesen.
+void openInputStream() {
+    stream_input = 1;
+    stream_staging = malloc(STREAM_STAGING_SIZE);
+    if (!stream_staging) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    if (fstat(STDIN_FILENO, &st) < 0) {
+        perror("fstat (stdin)");
+        exit(EXIT_FAILURE);
+    }
+    stream_flags = fcntl(STDIN_FILENO, F_GETFL);
+    if (!S_ISREG(st.st_mode) && stream_flags >= 0 &&
+        fcntl(STDIN_FILENO, F_SETFL, stream_flags | O_NONBLOCK) == 0) {
+        stream_pollable = 1;
+        atexit(restoreInputFlags);  // Auch bei Abbruch mit exit() zurücksetzen
+    }
+}
+
+// Funktion zum Freigeben der stdin-Puffer und Wiederherstellen der Flags von stdin
+void closeInputStream() {
+    restoreInputFlags();
+    free(stream_staging);
+    stream_staging = NULL;
+}
+
+// Funktion zum Nachlesen von stdin in den Zwischenpuffer, bis er voll ist, keine Daten
+// vorliegen (EAGAIN) oder das Dateiende erreicht ist
+void fillStaging() {
+    if (staged_start > 0) {
+        memmove(stream_staging, stream_staging + staged_start, staged_end - staged_start);
+        staged_end -= staged_start;
+        staged_start = 0;
+    }
+
+    while (!stream_eof && staged_end < STREAM_STAGING_SIZE) {
+        ssize_t n = read(STDIN_FILENO, stream_staging + staged_end, STREAM_STAGING_SIZE - staged_end);
+        if (n > 0) {
+            staged_end += (size_t)n;
+        } else if (n == 0) {
+            stream_eof = 1;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            perror("read (stdin)");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Funktion zum Bestimmen der Nutzdaten des nächsten Pakets von stdin. Ein unvollständiger Block bzw.
+// eine Zeile ohne Zeilenende wird nur mit allow_partial gesendet, sonst auf weitere Daten gewartet.
+int readStreamPayload(uint32_t seq_num, int allow_partial, const char **data) {
+    size_t staged = staged_end - staged_start;
+    if (staged < stream_slot_size && !stream_eof) {
+        fillStaging();
+        staged = staged_end - staged_start;
+    }
+    if (staged == 0) {
+        return stream_eof ? 0 : -1;
+    }
+
+    const char *start = stream_staging + staged_start;
+    size_t len = staged < stream_slot_size ? staged : stream_slot_size;
+    int complete = staged >= stream_slot_size || stream_eof;
+    if (!binary_mode) {
+        const char *newline = memchr(start, '\n', len);
+        if (newline) {
+            len = (size_t)(newline - start) + 1;
+            complete = 1;
+        }
+    }
+    if (!complete && !allow_partial) {
+        return -1;
+    }
+
+    char *dest = stream_slots + (size_t)(seq_num & ring_mask) * stream_slot_size;
+    memcpy(dest, start, len);
+    staged_start += len;
+    *data = dest;
+    return (int)len;
+}
+
+// Funktion zum Bestimmen der Nutzdaten des nächsten Pakets seq_num (Anwendungsschicht).
+// Im Binärmodus ist das ein Block fester Größe, sonst eine Zeile (höchstens max_line Bytes).
+// Aus einer Datei werden die Daten nicht kopiert. Gibt die Länge zurück, 0 am Dateiende und
+// -1, wenn von stdin noch nicht genug Daten vorliegen. allow_partial erlaubt dann ein kürzeres
+// Paket; der Sender setzt es nur, wenn nichts mehr unbestätigt ist (wie Nagle bei TCP).
+int readNextPayload(uint32_t seq_num, int allow_partial, const char **data) {
+    if (stream_input) {
+        return readStreamPayload(seq_num, allow_partial, data);
+    }
+
+    size_t remaining = input_size - input_offset;
+    if (remaining == 0) {
+        return 0;
+    }
+
+    size_t len;
+    if (binary_mode) {
+        len = remaining < (size_t)chunk_size ? remaining : (size_t)chunk_size;
+    } else {
+        size_t max_len = remaining < (size_t)max_line ? remaining : (size_t)max_line;
+        const char *newline = memchr(input_data + input_offset, '\n', max_len);
+        len = newline ? (size_t)(newline - (input_data + input_offset)) + 1 : max_len;
+    }
+
+    *data = input_data + input_offset;
+    input_offset += len;
+    return (int)len;
+}
+
+// Funktion zum Abfragen der monotonen Uhrzeit in Mikrosekunden
+long long nowMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Funktion zum Aktualisieren von SRTT, RTTVAR und RTO mit einer neuen RTT-Messung
+void updateRtt(long long sample) {
+    if (sample < 0) {
+        return;
+    }
+
+    if (!rtt_measured) {
+        srtt = sample;
+        rttvar = sample / 2;
+        rtt_measured = 1;
+    } else {
+        long long delta = srtt - sample;
+        if (delta < 0) {
+            delta = -delta;
+        }
+        rttvar = (3 * rttvar + delta) / 4;
+        srtt = (7 * srtt + sample) / 8;
+    }
+
+    // RTO = SRTT + max(G, 4 * RTTVAR), G ist die Auflösung des Timer-Rads
+    long long variance = 4 * rttvar;
+    if (variance < WHEEL_TICK) {
+        variance = WHEEL_TICK;
+    }
+    rto = srtt + variance;
+    if (rto < MIN_RTO) {
+        rto = MIN_RTO;
+    } else if (rto > MAX_RTO) {
+        rto = MAX_RTO;
+    }
+}
+
+// Funktion zum Verdoppeln des RTO nach einem Timeout (exponentielles Backoff)
+void backoffRto() {
+    rto *= 2;
+    if (rto > MAX_RTO) {
+        rto = MAX_RTO;
+    }
+}
+
+// Funktion zum Anlegen des Ringpuffers für gesendete Pakete.
+// Alle Einträge liegen in einem einzigen, an Cache-Zeilen ausgerichteten Block, der
+// während der gesamten Übertragung wiederverwendet wird.
+void initSendRing(int window_size) {
+    int needed = quorum > 0 ? window_size * QUORUM_LAG_WINDOWS : window_size;
+    int capacity = 1;
+    while (capacity < needed) {
+        capacity <<= 1;
+    }
+
+    void *slab;
+    if (posix_memalign(&slab, 64, capacity * sizeof(struct send_slot)) != 0) {
+        fprintf(stderr, "Failed to allocate retransmission buffer.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(slab, 0, capacity * sizeof(struct send_slot));
+
+    send_ring = slab;
+    ring_mask = capacity - 1;
+
+    // Von stdin braucht jeder Slot einen eigenen Puffer für seine Nutzdaten
+    if (stream_input) {
+        stream_slot_size = (size_t)(binary_mode ? chunk_size : max_line);
+        if (posix_memalign(&slab, 64, capacity * stream_slot_size) != 0) {
+            fprintf(stderr, "Failed to allocate stream buffers.\n");
+            exit(EXIT_FAILURE);
+        }
+        stream_slots = slab;
+    }
+}
+
+// Funktion zum Freigeben des Ringpuffers
+void freeSendRing() {
+    free(send_ring);
+    send_ring = NULL;
+    free(stream_slots);
+    stream_slots = NULL;
+}
+
+// Funktion zum Bestimmen des Ringpuffer-Eintrags einer Sequenznummer
+struct send_slot *sendSlot(uint32_t seq_num) {
+    return &send_ring[seq_num & ring_mask];
+}
+
+// Funktion zum Einlesen einer Rate in Bit/s mit optionalem Suffix k, M oder G, gibt Bytes/s zurück
+long long parseRate(const char *text) {
+    char *end;
+    double rate = strtod(text, &end);
+    if (*end == 'k' || *end == 'K') {
+        rate *= 1e3;
+        end++;
+    } else if (*end == 'm' || *end == 'M') {
+        rate *= 1e6;
+        end++;
+    } else if (*end == 'g' || *end == 'G') {
+        rate *= 1e9;
+        end++;
+    }
+    if (end == text || *end != '\0' || rate < 8) {
+        fprintf(stderr, "Invalid rate: %s\n", text);
+        exit(EXIT_FAILURE);
+    }
+    return (long long)(rate / 8);
+}
+
+// Funktion zum Bestimmen des nutzbaren Fensters: Minimum aus Überlastfenster und Fenstergröße
+uint32_t sendWindow() {
+    int window = (int)cwnd;
+    return (uint32_t)(window < max_window ? window : max_window);
+}
+
+// Funktion zum Vergrößern des Überlastfensters um acked neu bestätigte Pakete:
+// im Slow Start um ein Paket pro Bestätigung, danach um ein Paket pro Fenster (additive Erhöhung)
+void congestionAck(int acked) {
+    if (cwnd < ssthresh) {
+        cwnd += acked;
+    } else {
+        cwnd += (double)acked / cwnd;
+    }
+    if (cwnd > max_window) {
+        cwnd = max_window;
+    }
+}
+
+// Funktion zur Reaktion auf den Verlust eines Pakets (multiplikative Verringerung).
+// Pro Fenster wird nur einmal verringert; simulierte Verluste sind keine Überlast und werden übergangen.
+void congestionLoss(uint32_t seq_num, uint32_t next_seq, int timeout) {
+    if (sendSlot(seq_num)->simulated_loss || seqLess(seq_num, recovery_seq)) {
+        return;
+    }
+
+    double old_cwnd = cwnd;
+    ssthresh = cwnd / 2 < MIN_CWND ? MIN_CWND : cwnd / 2;
+    cwnd = timeout ? MIN_CWND : ssthresh;  // Nach einem Timeout ist der Zustand des Netzes unbekannt
+    recovery_seq = next_seq;
+    printf("Congestion (%s of packet %u): cwnd %.1f -> %.1f\n", timeout ? "timeout" : "NACK", seq_num, old_cwnd, cwnd);
+}
+
+// Funktion zur Berechnung der Pacing-Rate in Bytes/s: das Überlastfenster wird über eine SRTT verteilt,
+// begrenzt durch -r. 0 bedeutet unbegrenzt (noch keine RTT-Messung und keine Obergrenze).
+double pacingRate() {
+    double rate = 0;
+    if (rtt_measured && srtt > 0) {
+        double gain = cwnd < ssthresh ? PACING_GAIN_SS : PACING_GAIN_CA;
+        rate = gain * cwnd * average_packet * 1e6 / srtt;
+    }
+    if (max_rate > 0 && (rate == 0 || rate > max_rate)) {
+        rate = max_rate;
+    }
+    return rate;
+}
+
+// Funktion zum Bestimmen des Zeitpunkts, ab dem das nächste Paket gesendet werden darf.
+// Der Token-Bucket wird dabei bis zur aktuellen Zeit aufgefüllt, höchstens auf PACING_BURST Pakete.
+long long pacingDeadline() {
+    long long now = nowMicros();
+    double rate = pacingRate();
+    double burst = PACING_BURST * average_packet;
+
+    if (rate <= 0) {
+        tokens = burst;
+    } else {
+        tokens += rate * (now - token_time) / 1e6;
+        if (tokens > burst) {
+            tokens = burst;
+        }
+    }
+    token_time = now;
+
+    // Pakete werden bei positivem Guthaben gesendet und dürfen es ins Negative ziehen
+    return tokens >= 0 ? now : now + (long long)(-tokens * 1e6 / rate);
+}
+
+// Funktion zum Abbuchen eines gesendeten Pakets vom Token-Bucket
+void consumeTokens(int packet_len, int new_data) {
+    tokens -= packet_len;
+    if (new_data) {
+        average_packet = (7 * average_packet + packet_len) / 8;
+    }
+}
+
+// Funktion zum Initialisieren des Timer-Rads
+void initTimerWheel() {
+    memset(wheel, 0, sizeof(wheel));
+    wheel_cursor = 0;
+    wheel_time = nowMicros();
+    armed_timers = 0;
+}
+
+// Funktion zum Bestimmen des Zeitpunkts des nächsten belegten Slots im Timer-Rad
+long long nextWheelDeadline() {
+    for (int i = 1; i <= WHEEL_SLOTS; i++) {
+        if (wheel[(wheel_cursor + i) % WHEEL_SLOTS]) {
+            return wheel_time + (long long)i * WHEEL_TICK;
+        }
+    }
+    return -1;  // Kein Timer aktiv
+}
+
+// Funktion zum Stoppen des Timers einer Sequenznummer in O(1)
+void cancelTimer(uint32_t seq_num) {
+    struct retransmit_timer *timer = &sendSlot(seq_num)->timer;
+    if (!timer->armed) {
+        return;
+    }
+
+    // Timer aus der Liste seines Slots aushängen
+    if (timer->prev) {
+        timer->prev->next = timer->next;
+    } else {
+        wheel[timer->slot] = timer->next;
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+
+    timer->prev = timer->next = NULL;
+    timer->armed = 0;
+    armed_timers--;
+}
+
+// Funktion zum (Neu-)Starten des Timers einer Sequenznummer in O(1)
+void armTimer(uint32_t seq_num, long long timeout) {
+    cancelTimer(seq_num);
+
+    // Anzahl der Ticks bis zum Ablauf, mindestens ein Tick
+    long long ticks = (timeout + WHEEL_TICK - 1) / WHEEL_TICK;
+    if (ticks < 1) {
+        ticks = 1;
+    }
+
+    int slot = (int)((wheel_cursor + ticks) % WHEEL_SLOTS);
+    struct retransmit_timer *timer = &sendSlot(seq_num)->timer;
+    timer->seq_num = seq_num;
+    timer->slot = slot;
+    timer->rounds = (int)((ticks - 1) / WHEEL_SLOTS);
+    timer->armed = 1;
+
+    // Timer am Anfang der Liste des Slots einhängen
+    timer->prev = NULL;
+    timer->next = wheel[slot];
+    if (wheel[slot]) {
+        wheel[slot]->prev = timer;
+    }
+    wheel[slot] = timer;
+    armed_timers++;
+}
+
+// Funktion zum Bestimmen der MTU auf dem Weg zur Gruppe, 0 wenn unbekannt. Ohne Zonenindex lässt
+// sich ein Socket nicht mit einer link-lokalen Gruppe verbinden; dann gilt die kleinste MTU der
+// aktiven multicastfähigen Schnittstellen.
+int pathMtu(const struct sockaddr_in6 *dest_addr) {
+    int mtu = 0;
+    int probe = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (probe < 0) {
+        return 0;
+    }
+
+    socklen_t mtu_len = sizeof(mtu);
+    if (connect(probe, (const struct sockaddr *)dest_addr, sizeof(*dest_addr)) < 0 ||
+        getsockopt(probe, IPPROTO_IPV6, IPV6_MTU, &mtu, &mtu_len) < 0) {
+        mtu = 0;
+        struct ifaddrs *interfaces;
+        if (getifaddrs(&interfaces) == 0) {
+            for (struct ifaddrs *ifa = interfaces; ifa; ifa = ifa->ifa_next) {
+                unsigned flags = ifa->ifa_flags;
+                if (!(flags & IFF_UP) || !(flags & IFF_MULTICAST) || (flags & IFF_LOOPBACK)) {
+                    continue;
+                }
+                struct ifreq ifr;
+                memset(&ifr, 0, sizeof(ifr));
+                snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", ifa->ifa_name);
+                if (ioctl(probe, SIOCGIFMTU, &ifr) == 0 && (mtu == 0 || ifr.ifr_mtu < mtu)) {
+                    mtu = ifr.ifr_mtu;
+                }
+            }
+            freeifaddrs(interfaces);
+        }
+    }
+    close(probe);
+    return mtu;
 }
 
 // Funktion zum Initialisieren des UDPv6-Sendersockets (SR-Protokollschicht)
@@ -53,6 +715,20 @@ int initializeSenderSocket(const char *multicast_addr, int port, struct sockaddr
     }
     #endif
 
+    // Unterstützung für UDP GSO prüfen; 0 als Segmentgröße ändert am Verhalten des Sockets nichts
+    int segment_size = 0;
+    if (setsockopt(sock, SOL_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size)) < 0) {
+        printf("UDP GSO not available, sending single datagrams.\n");
+        gso_enabled = 0;
+    }
+
+    // Zero-Copy-Versand anmelden; ohne Unterstützung durch den Kernel wird normal kopiert
+    if (zerocopy && setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &optval, sizeof(optval)) < 0) {
+        perror("setsockopt(SO_ZEROCOPY)");
+        printf("Zero-copy not available, using regular sends.\n");
+        zerocopy = 0;
+    }
+
     // Zieladresse vorbereiten
     memset(dest_addr, 0, sizeof(*dest_addr));
     dest_addr->sin6_family = AF_INET6;               // IPv6-Protokollfamilie
@@ -65,165 +741,1207 @@ int initializeSenderSocket(const char *multicast_addr, int port, struct sockaddr
         exit(EXIT_FAILURE);
     }
 
+    // Ein Segment, das nicht in die MTU passt, lehnt der Kernel bei UDP GSO ab (statt zu fragmentieren);
+    // solche Pakete gehen einzeln hinaus
+    int mtu = pathMtu(dest_addr);
+    if (mtu > 40 + 8) {
+        gso_max_segment = (size_t)mtu - 40 - 8;  // Abzüglich IPv6- und UDP-Kopf
+    }
+
     return sock;  // Gibt den erstellten Socket zurück
 }
 
-// Funktion zum Senden einer Kontrollnachricht
-void sendControlMessage(int sock, struct sockaddr_in6 *dest_addr, const char *message) {
-    if (sendto(sock, message, strlen(message), 0, (struct sockaddr *)dest_addr, sizeof(*dest_addr)) < 0) {
+// Funktion zum Senden einer Kontrollnachricht (Nutzdaten nur beim HELLO im FEC-Modus)
+void sendControlMessage(int sock, struct sockaddr_in6 *dest_addr, uint8_t type, uint8_t flags, uint32_t seq_num,
+                        const void *payload, int length) {
+    char packet[HEADER_SIZE + sizeof(struct fec_params)];
+    int packet_len = buildPacket(packet, sizeof(packet), type, flags, session_id, seq_num, payload, length);
+
+    if (sendto(sock, packet, packet_len, 0, (struct sockaddr *)dest_addr, sizeof(*dest_addr)) < 0) {
         perror("sendto (control)");
     } else {
-        printf("Sent control message: %s\n", message);
+        printf("Sent control message: %s\n", packetTypeName(type));
+    }
+}
+
+// Funktion zum Stellen eines timerfd auf einen absoluten Zeitpunkt (CLOCK_MONOTONIC, Mikrosekunden)
+void setTimerFd(int timer_fd, long long deadline) {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = deadline / 1000000;
+    spec.it_value.tv_nsec = (deadline % 1000000) * 1000;
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+        perror("timerfd_settime");
+    }
+}
+
+// Funktion zum Anlegen der epoll-Instanz für Socket (flankengesteuert) und timerfd
+int initEventLoop(int sock, int *timer_fd) {
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+    }
+
+    *timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (*timer_fd < 0) {
+        perror("timerfd_create");
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = sock;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &event) < 0) {
+        perror("epoll_ctl (socket)");
+        exit(EXIT_FAILURE);
+    }
+
+    event.events = EPOLLIN;
+    event.data.fd = *timer_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, *timer_fd, &event) < 0) {
+        perror("epoll_ctl (timerfd)");
+        exit(EXIT_FAILURE);
+    }
+
+    return epoll_fd;
+}
+
+// Funktion zum Verknüpfen der Empfangspuffer mit den mmsghdr-Strukturen
+void initReceiveBatch() {
+    for (int i = 0; i < RECV_BATCH; i++) {
+        recv_iovs[i].iov_base = recv_buffers[i];
+        recv_iovs[i].iov_len = MAX_PACKET_SIZE;
+        memset(&recv_msgs[i], 0, sizeof(recv_msgs[i]));
+        recv_msgs[i].msg_hdr.msg_iov = &recv_iovs[i];
+        recv_msgs[i].msg_hdr.msg_iovlen = 1;
+        recv_msgs[i].msg_hdr.msg_name = &recv_addrs[i];
+    }
+}
+
+// Funktion zum Setzen einer Empfangszeitschranke für blockierende Aufrufe (0 = unbegrenzt warten)
+void setReceiveTimeout(int sock, long long timeout) {
+    struct timeval tv;
+    tv.tv_sec = timeout / 1000000;
+    tv.tv_usec = timeout % 1000000;
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+        perror("setsockopt(SO_RCVTIMEO)");
+    }
+}
+
+// Funktion zum Empfangen und Prüfen eines Pakets dieser Übertragung.
+// Fehlerhafte Pakete und Pakete anderer Sitzungen werden übersprungen; gibt -1 bei Fehler oder Zeitablauf zurück.
+int receivePacket(int sock, char *buffer, int buffer_size, struct packet_header *header, const char **payload,
+                  struct sockaddr_in6 *src_addr) {
+    while (1) {
+        socklen_t src_addr_len = sizeof(*src_addr);
+
+        ssize_t len = recvfrom(sock, buffer, buffer_size, 0, (struct sockaddr *)src_addr, &src_addr_len);
+        if (len < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("recvfrom");
+            }
+            return -1;
+        }
+        if (parsePacket(buffer, (int)len, header, payload) < 0) {
+            printf("Malformed packet (%zd bytes) ignored.\n", len);
+            continue;
+        }
+        if (header->session_id != session_id) {
+            continue;
+        }
+        return 0;
+    }
+}
+
+// Funktion zum Suchen eines registrierten Empfängers anhand seiner Adresse, -1 wenn unbekannt
+int findReceiver(const struct sockaddr_in6 *addr) {
+    for (int r = 0; r < receiver_count; r++) {
+        if (receivers[r].addr.sin6_port == addr->sin6_port &&
+            memcmp(&receivers[r].addr.sin6_addr, &addr->sin6_addr, sizeof(addr->sin6_addr)) == 0) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+// Funktion zum Registrieren eines Empfängers, der auf das HELLO geantwortet hat
+void registerReceiver(const struct sockaddr_in6 *addr) {
+    if (findReceiver(addr) >= 0) {
+        return;  // Doppeltes HELLO ACK
+    }
+    if (receiver_count == MAX_RECEIVERS) {
+        printf("Too many receivers, HELLO ACK ignored.\n");
+        return;
+    }
+
+    struct receiver *receiver = &receivers[receiver_count];
+    memset(receiver, 0, sizeof(*receiver));
+    receiver->addr = *addr;
+    char addr_str[INET6_ADDRSTRLEN];
+    if (inet_ntop(AF_INET6, &addr->sin6_addr, addr_str, sizeof(addr_str)) == NULL) {
+        strcpy(addr_str, "?");
     }
+    snprintf(receiver->name, sizeof(receiver->name), "[%s]:%u", addr_str, ntohs(addr->sin6_port));
+    receiver->next_expected = initial_seq;
+    receiver->last_heard = nowMicros();
+    receiver->alive = 1;
+    alive_mask |= 1ULL << receiver_count;
+    receiver_count++;
+    printf("Receiver %s registered.\n", receiver->name);
 }
 
-// Funktion zum Verbindungsaufbau
+// Funktion zum Bestimmen der Anzahl an Empfängern, die ein Paket bestätigen müssen
+int requiredAcks() {
+    return quorum > 0 ? quorum : __builtin_popcountll(alive_mask);
+}
+
+// Funktion zum Verbindungsaufbau.
+// Alle Empfänger, die innerhalb von REGISTRATION_TIME nach dem ersten HELLO ACK antworten, nehmen an der Übertragung teil;
+// mit -n wird gewartet, bis so viele geantwortet haben. Das HELLO wird nach jedem RTO mit exponentiellem Backoff
+// wiederholt, damit ein verlorenes HELLO keinen Empfänger ausschließt. Aufgegeben wird nach RECEIVER_TIMEOUT.
 void establishConnection(int sock, struct sockaddr_in6 *dest_addr) {
-    sendControlMessage(sock, dest_addr, "HELLO");
+    // Im FEC-Modus erfährt der Empfänger Blockgröße und Paritätsanzahl aus dem HELLO
+    struct fec_params params;
+    uint8_t flags = binary_mode ? PKT_FLAG_BINARY : 0;
+    if (fec_data > 0) {
+        params.data_count = (uint8_t)fec_data;
+        params.parity_count = (uint8_t)fec_parity;
+        params.max_payload = htons((uint16_t)(binary_mode ? chunk_size : max_line));
+        flags |= PKT_FLAG_FEC;
+    }
+    sendControlMessage(sock, dest_addr, PKT_HELLO, flags, initial_seq, &params, fec_data > 0 ? (int)sizeof(params) : 0);
     printf("Waiting for HELLO ACK...\n");
 
-    char buffer[BUF_SIZE];
+    char buffer[MAX_PACKET_SIZE];
+    struct packet_header header;
+    const char *payload;
     struct sockaddr_in6 src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
+    long long hello_time = nowMicros();     // Sendezeitpunkt für die erste RTT-Messung
+    long long deadline = hello_time + RECEIVER_TIMEOUT;
+    long long interval = rto;
+    long long next_resend = hello_time + interval;
+    long long registration_end = -1;        // REGISTRATION_TIME nach dem ersten HELLO ACK, -1 solange keins kam
+    int resent = 0;                         // Nach einer Wiederholung ist das HELLO ACK nicht eindeutig zuordenbar (Karn)
+
+    while (1) {
+        long long now = nowMicros();
+        if (expected_receivers > 0 ? receiver_count >= expected_receivers
+                                   : registration_end >= 0 && now >= registration_end && receiver_count >= quorum) {
+            break;
+        }
+        if (now >= deadline) {
+            break;
+        }
+        if (now >= next_resend) {
+            printf("HELLO not acknowledged by all receivers. Resending...\n");
+            sendControlMessage(sock, dest_addr, PKT_HELLO, flags, initial_seq, &params,
+                               fec_data > 0 ? (int)sizeof(params) : 0);
+            resent = 1;
+            interval = interval * 2 > MAX_RTO ? MAX_RTO : interval * 2;
+            next_resend = now + interval;
+        }
 
-    ssize_t len = recvfrom(sock, buffer, sizeof(buffer) - 1, 0, (struct sockaddr *)&src_addr, &src_addr_len);
-    if (len > 0) {
-        buffer[len] = '\0';
-        if (strcmp(buffer, "HELLO ACK") == 0) {
-            printf("Connection established.\n");
+        // Höchstens bis zur nächsten Wiederholung, zum Ende der Registrierung bzw. zum Aufgeben blockieren
+        long long wake = next_resend < deadline ? next_resend : deadline;
+        if (registration_end >= 0 && registration_end < wake) {
+            wake = registration_end;
+        }
+        setReceiveTimeout(sock, wake - now > 0 ? wake - now : 1);
+        if (receivePacket(sock, buffer, sizeof(buffer), &header, &payload, &src_addr) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (header.type != PKT_HELLO_ACK) {
+            if (receiver_count == 0) {
+                printf("Unexpected message: %s\n", packetTypeName(header.type));
+                exit(EXIT_FAILURE);
+            }
+            continue;
+        }
+        if (receiver_count == 0) {
+            registration_end = nowMicros() + REGISTRATION_TIME;
+            registerReceiver(&src_addr);
+            if (!resent) {
+                updateRtt(nowMicros() - hello_time);
+                printf("Connection established (RTT %lld us, RTO %lld us).\n", srtt, rto);
+            } else {
+                printf("Connection established (no RTT sample after resend, RTO %lld us).\n", rto);
+            }
         } else {
-            printf("Unexpected message: %s\n", buffer);
-            exit(EXIT_FAILURE);
+            registerReceiver(&src_addr);
         }
-    } else {
-        perror("recvfrom (HELLO ACK)");
+    }
+    setReceiveTimeout(sock, 0);
+
+    if (receiver_count == 0) {
+        fprintf(stderr, "No valid HELLO ACK received.\n");
+        exit(EXIT_FAILURE);
+    }
+    printf("%d receiver(s) registered.\n", receiver_count);
+    if (quorum > receiver_count) {
+        fprintf(stderr, "Quorum of %d receivers not reached.\n", quorum);
         exit(EXIT_FAILURE);
     }
 }
 
-// Funktion zum Verbindungsabbau
+// Funktion zum Verbindungsabbau: wartet auf das CLOSE ACK aller noch teilnehmenden Empfänger.
+// Das CLOSE wird nach jedem RTO mit exponentiellem Backoff wiederholt, da ein Server im
+// stdout-Modus erst nach einem empfangenen CLOSE beendet; aufgegeben wird nach RECEIVER_TIMEOUT.
 void terminateConnection(int sock, struct sockaddr_in6 *dest_addr) {
-    sendControlMessage(sock, dest_addr, "CLOSE");
+    sendControlMessage(sock, dest_addr, PKT_CLOSE, 0, 0, NULL, 0);
     printf("Waiting for CLOSE ACK...\n");
 
-    char buffer[BUF_SIZE];
+    char buffer[MAX_PACKET_SIZE];
+    struct packet_header header;
+    const char *payload;
     struct sockaddr_in6 src_addr;
-    socklen_t src_addr_len = sizeof(src_addr);
+    int pending = __builtin_popcountll(alive_mask);
+    long long interval = rto;
+    long long now = nowMicros();
+    long long deadline = now + RECEIVER_TIMEOUT;
+    long long next_resend = now + interval;
 
-    ssize_t len = recvfrom(sock, buffer, sizeof(buffer) - 1, 0, (struct sockaddr *)&src_addr, &src_addr_len);
-    if (len > 0) {
-        buffer[len] = '\0';
-        if (strcmp(buffer, "CLOSE ACK") == 0) {
-            printf("Connection terminated.\n");
-        } else {
-            printf("Unexpected message: %s\n", buffer);
+    while (pending > 0) {
+        now = nowMicros();
+        if (now >= deadline) {
+            printf("%d receiver(s) did not acknowledge CLOSE.\n", pending);
+            break;
         }
-    } else {
-        perror("recvfrom (CLOSE ACK)");
+        if (now >= next_resend) {
+            printf("CLOSE not acknowledged. Resending...\n");
+            sendControlMessage(sock, dest_addr, PKT_CLOSE, 0, 0, NULL, 0);
+            interval = interval * 2 > MAX_RTO ? MAX_RTO : interval * 2;
+            next_resend = now + interval;
+        }
+
+        // Höchstens bis zur nächsten Wiederholung bzw. zum Aufgeben blockieren
+        long long wait = (next_resend < deadline ? next_resend : deadline) - now;
+        setReceiveTimeout(sock, wait > 0 ? wait : 1);
+        if (receivePacket(sock, buffer, sizeof(buffer), &header, &payload, &src_addr) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            printf("%d receiver(s) did not acknowledge CLOSE.\n", pending);
+            break;
+        }
+        if (header.type == PKT_CLOSE_ACK) {
+            int r = findReceiver(&src_addr);
+            if (r >= 0 && receivers[r].alive && !receivers[r].closed) {
+                receivers[r].closed = 1;
+                pending--;
+            }
+            continue;
+        }
+        // Verspätete ACKs/NACKs aus der Datenphase überspringen
+        if (header.type == PKT_ACK || header.type == PKT_NACK || header.type == PKT_HELLO_ACK) {
+            continue;
+        }
+        printf("Unexpected message: %s\n", packetTypeName(header.type));
+        break;
+    }
+    if (pending == 0) {
+        printf("Connection terminated.\n");
     }
 }
 
-// Funktion zum Senden eines Pakets über UDPv6 (SR-Protokollschicht)
-void sendPacket(int sock, struct sockaddr_in6 *dest_addr, int seq_num, const char *data, float error_rate) {
-    char packet[BUF_SIZE];  // Puffer für das Paket
+// Funktion zur Ausgabe, welche Empfänger die Datei vollständig erhalten haben
+void printReceiverSummary(int transfer_complete) {
+    for (int r = 0; r < receiver_count; r++) {
+        const char *state = !receivers[r].alive ? "dropped, output incomplete"
+                          : transfer_complete ? "complete" : "transfer aborted, output incomplete";
+        printf("Receiver %s: %s\n", receivers[r].name, state);
+    }
+}
+
+// Funktion zum Vermerken abgeschlossener Zero-Copy-Übertragungen aus der Fehlerwarteschlange des Sockets.
+// Hat der Kernel trotzdem kopiert (z. B. bei lokaler Zustellung), lohnt Zero-Copy nicht und wird abgeschaltet.
+void reapCompletions(int sock) {
+    while (zc_outstanding > 0) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("recvmsg (MSG_ERRQUEUE)");
+            }
+            return;
+        }
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)) {
+                continue;
+            }
+            struct sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            // Abgeschlossen sind die Nummern ee_info bis einschließlich ee_data
+            for (uint32_t id = err.ee_info;; id++) {
+                for (int j = 0; j < zc_count[id % ZC_TRACK]; j++) {
+                    sendSlot(zc_log[(zc_first[id % ZC_TRACK] + j) % ZC_TRACK])->zc_pending--;
+                }
+                zc_outstanding -= zc_count[id % ZC_TRACK];
+                if (id == err.ee_data) {
+                    break;
+                }
+            }
+            if ((err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && zerocopy) {
+                printf("Kernel copied zero-copy sends, switching to regular sends.\n");
+                zerocopy = 0;
+            }
+        }
+    }
+}
+
+// Funktion zum Aufgeben der Zero-Copy-Verfolgung, wenn eine Abschlussmeldung ausbleibt. Nach
+// ZC_SLOT_TIMEOUT hat der Kernel die Pakete längst gesendet; die Slots werden wieder freigegeben
+// und alle weiteren Pakete kopiert, damit keine verlorene Meldung den Sender erneut aufhält.
+void abandonZerocopy() {
+    printf("Zero-copy completion overdue, switching to regular sends.\n");
+    for (int i = 0; i <= ring_mask; i++) {
+        send_ring[i].zc_pending = 0;
+    }
+    zc_outstanding = 0;
+    zerocopy = 0;
+}
+
+// Funktion zum Warten, bis der Kernel alle Zero-Copy-Übertragungen abgeschlossen hat,
+// bevor Ringpuffer und eingeblendete Datei freigegeben werden
+void drainCompletions(int sock) {
+    long long deadline = nowMicros() + ZC_DRAIN_TIMEOUT * 1000LL;
+    reapCompletions(sock);
+    while (zc_outstanding > 0 && nowMicros() < deadline) {
+        struct pollfd pfd = {.fd = sock, .events = 0};  // POLLERR wird immer gemeldet
+        poll(&pfd, 1, ZC_DRAIN_TIMEOUT);
+        reapCompletions(sock);
+    }
+    if (zc_outstanding > 0) {
+        printf("Warning: %d zero-copy sends not completed.\n", zc_outstanding);
+    }
+}
+
+// Funktion zur Berechnung der Länge eines eingereihten Pakets
+size_t queuedLength(int i) {
+    size_t length = 0;
+    for (size_t j = 0; j < send_msgs[i].msg_hdr.msg_iovlen; j++) {
+        length += send_msgs[i].msg_hdr.msg_iov[j].iov_len;
+    }
+    return length;
+}
+
+// Funktion zum Zusammenfassen der eingereihten Pakete ab first zu Superdatagrammen, gibt deren Anzahl zurück.
+// Ein Superdatagramm besteht aus gleich großen Datenpaketen, nur das letzte darf kürzer sein. Da jedes
+// Datenpaket zwei iovecs belegt, liegen die iovecs aufeinanderfolgender Pakete lückenlos in send_iovs.
+int buildSuperDatagrams(int first) {
+    int count = 0;
+    for (int i = first; i < send_count; i += gso_members[count++]) {
+        struct msghdr *msg = &gso_msgs[count].msg_hdr;
+        *msg = send_msgs[i].msg_hdr;
+
+        size_t segment = queuedLength(i);
+        size_t total = segment;
+        int members = 1;
+        if (gso_enabled && msg->msg_iovlen == 2 && segment <= gso_max_segment) {
+            while (i + members < send_count && members < GSO_MAX_SEGMENTS) {
+                size_t length = queuedLength(i + members);
+                if (send_msgs[i + members].msg_hdr.msg_iovlen != 2 || length > segment ||
+                    total + length > GSO_MAX_BYTES) {
+                    break;
+                }
+                total += length;
+                members++;
+                if (length < segment) {
+                    break;
+                }
+            }
+        }
+        gso_members[count] = members;
+
+        if (members > 1) {
+            msg->msg_iovlen = 2 * members;
+            msg->msg_control = gso_control[count];
+            msg->msg_controllen = sizeof(gso_control[count]);
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t segment_size = (uint16_t)segment;
+            memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+        }
+    }
+    return count;
+}
+
+// Funktion zum Vermerken der Pakete eines mit MSG_ZEROCOPY übergebenen Superdatagramms.
+// Ihre Seiten gehören bis zur Abschlussmeldung dem Kernel.
+void trackZerocopy(int first, int members) {
+    uint32_t slot = zc_next_id % ZC_TRACK;
+    zc_first[slot] = zc_log_next;
+    zc_count[slot] = members;
+    for (int i = first; i < first + members; i++) {
+        zc_log[zc_log_next++ % ZC_TRACK] = send_seqs[i];
+        sendSlot(send_seqs[i])->zc_pending++;
+    }
+    zc_outstanding += members;
+    zc_next_id++;
+}
+
+// Funktion zum Überspringen einer Zero-Copy-Nummer, die eine abgelehnte Nachricht verbraucht hat.
+// Der Kernel meldet auch sie als abgeschlossen; ohne Pakete gibt die Meldung keinen Slot frei.
+void skipZerocopyId() {
+    zc_count[zc_next_id % ZC_TRACK] = 0;
+    zc_next_id++;
+}
+
+// Funktion zur Prüfung, ob unter den ersten count Nachrichten ein Superdatagramm ist
+int hasSuperDatagram(int count) {
+    for (int g = 0; g < count; g++) {
+        if (gso_members[g] > 1) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Funktion zum Senden aller eingereihten Pakete mit möglichst wenigen sendmmsg()-Aufrufen.
+// Gleich große Datenpakete gehen per UDP GSO als Superdatagramm hinaus. Mit -z werden Datenpakete
+// ohne Kopie übergeben, solange noch Einträge zur Verfolgung frei sind.
+void flushPackets(int sock) {
+    int flags = 0;
+    if (zerocopy && !send_copy_only && zc_outstanding + send_count <= ZC_TRACK) {
+        flags = MSG_ZEROCOPY;
+    }
+
+    int sent = 0;
+    while (sent < send_count) {
+        int count = buildSuperDatagrams(sent);
+
+        // Lehnt der Kernel ein Superdatagramm ab, hat er die Nachricht schon aufgebaut und eine
+        // Zero-Copy-Nummer verbraucht. Bis GSO einmal funktioniert hat, daher ohne MSG_ZEROCOPY senden.
+        int call_flags = flags;
+        if (!gso_verified && hasSuperDatagram(count)) {
+            call_flags = 0;
+        }
+
+        int n = sendmmsg(sock, gso_msgs, count, call_flags);
+        if (n < 0) {
+            if (errno == ENOBUFS && call_flags) {
+                flags = 0;  // Speichergrenze für Abschlussmeldungen erreicht, dieses Mal kopieren
+                continue;
+            }
+            if ((errno == EIO || errno == EINVAL || errno == EMSGSIZE) && gso_enabled && gso_members[0] > 1) {
+                // z. B. keine Prüfsummenberechnung durch die Netzwerkkarte oder geänderte Route
+                printf("Kernel rejected UDP GSO (%s), sending single datagrams.\n", strerror(errno));
+                if (call_flags) {
+                    skipZerocopyId();
+                }
+                gso_enabled = 0;
+                continue;
+            }
+            perror("sendmmsg");
+            break;
+        }
+
+        for (int g = 0; g < n; g++) {
+            if (call_flags) {
+                trackZerocopy(sent, gso_members[g]);
+            }
+            if (gso_members[g] > 1) {
+                gso_verified = 1;
+            }
+            sent += gso_members[g];
+        }
+    }
+    if (sent > 0) {
+        last_transmit = nowMicros();
+    }
+    send_count = 0;
+    send_copy_only = 0;
+}
+
+// Funktion zum Einreihen eines Pakets in den Sendestapel. Kopf und Nutzdaten werden per iovec
+// direkt aus dem Ringpuffer und der eingeblendeten Datei gesendet, ohne sie zusammenzukopieren.
+void queuePacket(int sock, struct sockaddr_in6 *dest_addr, uint32_t seq_num) {
+    if (send_count == SEND_BATCH) {
+        flushPackets(sock);
+    }
 
-    // Erstellen des Paketinhalts: Sequenznummer + Daten
-    snprintf(packet, sizeof(packet), "%d:%s", seq_num, data);
+    struct send_slot *slot = sendSlot(seq_num);
+    int i = send_count++;
+    send_seqs[i] = seq_num;
+    send_iovs[i][0].iov_base = &slot->header;
+    send_iovs[i][0].iov_len = HEADER_SIZE;
+    send_iovs[i][1].iov_base = (void *)slot->data;
+    send_iovs[i][1].iov_len = slot->length;
 
-    // Speichert das gesendete Paket im Puffer
-    strncpy(sent_packets[seq_num], packet, BUF_SIZE);
-    packet_lengths[seq_num] = strlen(packet);
+    memset(&send_msgs[i], 0, sizeof(send_msgs[i]));
+    send_msgs[i].msg_hdr.msg_name = dest_addr;
+    send_msgs[i].msg_hdr.msg_namelen = sizeof(*dest_addr);
+    send_msgs[i].msg_hdr.msg_iov = send_iovs[i];
+    send_msgs[i].msg_hdr.msg_iovlen = 2;
+}
+
+// Funktion zum Senden eines Pakets über UDPv6 (SR-Protokollschicht)
+void sendPacket(int sock, struct sockaddr_in6 *dest_addr, uint32_t seq_num, const char *data, int data_len,
+                float error_rate) {
+    // Für eine spätere Wiederholung werden nur Kopf und Position der Nutzdaten gespeichert
+    struct send_slot *slot = sendSlot(seq_num);
+    fillHeader(&slot->header, PKT_DATA, 0, session_id, seq_num, data, (uint16_t)data_len);
+    slot->data = data;
+    slot->length = data_len;
+    slot->ack_mask = 0;
+    slot->acked = 0;
+    slot->resend_time = 0;
+    slot->send_time = nowMicros();
+    slot->rtt_sample_valid = 1;
+    slot->simulated_loss = 0;
+    consumeTokens(HEADER_SIZE + data_len, 1);
 
     // Zufällige Zahl zur Simulation eines Fehlers generieren
     float random_value = (float)rand() / RAND_MAX;
 
     // Wenn der zufällige Wert kleiner als die Fehlerquote ist, überspringe das Senden
     if (random_value < error_rate) {
-        printf("Packet %d dropped due to simulated error (error rate: %.2f)\n", seq_num, error_rate);
+        printf("Packet %u dropped due to simulated error (error rate: %.2f)\n", seq_num, error_rate);
+        slot->simulated_loss = 1;
         return;
     }
 
-    // Senden des Pakets an die Zieladresse
-    if (sendto(sock, packet, strlen(packet), 0, (struct sockaddr *)dest_addr, sizeof(*dest_addr)) < 0) {
-        perror("sendto");
+    // Paket für den nächsten sendmmsg()-Aufruf einreihen
+    queuePacket(sock, dest_addr, seq_num);
+    if (binary_mode) {
+        printf("Sent packet %u: %d bytes\n", seq_num, data_len);
+    } else {
+        printf("Sent packet %u: %.*s", seq_num, data_len, data);  // Ausgabe der gesendeten Sequenznummer und Daten
     }
-    printf("Sent packet %d: %s", seq_num, data);  // Ausgabe der gesendeten Sequenznummer und Daten
 }
 
-// Verwaltung von Timern und Ereignissen (SR-Protokollschicht)
-void manageTimersAndEvents(int sock, FILE *file, struct sockaddr_in6 *dest_addr, float error_rate) {
-    fd_set readfds;                      // Datei-Deskriptoren-Menge für select()
-    struct timeval interval = {0, DEFAULT_INTERVAL};  // Zeitintervall für das Senden
-    char buffer[BUF_SIZE];               // Puffer für das Lesen von Zeilen aus der Datei
-    int seq_num = 0;                     // Aktuelle Sequenznummer des Pakets
-    int timeout_count = 0;               // Zählt, wie oft das Timeout erreicht wurde
+// Funktion zum Zurücksetzen der Paritätspakete für den FEC-Block ab start_seq
+void resetParity(uint32_t start_seq) {
+    block_start = start_seq;
+    block_fill = 0;
+    for (int j = 0; j < fec_parity; j++) {
+        parity_packets[j].data_len = 0;
+        parity_packets[j].length_xor = 0;
+    }
+}
 
-    while (1) {
-        FD_ZERO(&readfds);
-        FD_SET(sock, &readfds);
+// Funktion zum Einreihen eines Paritätspakets in den Sendestapel
+void queueParityPacket(int sock, struct sockaddr_in6 *dest_addr, struct parity_packet *parity) {
+    if (send_count == SEND_BATCH) {
+        flushPackets(sock);
+    }
+
+    int i = send_count++;
+    send_copy_only = 1;  // Paritätspuffer werden sofort wiederverwendet
+    send_iovs[i][0].iov_base = &parity->header;
+    send_iovs[i][0].iov_len = HEADER_SIZE + FEC_HEADER_SIZE + parity->data_len;
+
+    memset(&send_msgs[i], 0, sizeof(send_msgs[i]));
+    send_msgs[i].msg_hdr.msg_name = dest_addr;
+    send_msgs[i].msg_hdr.msg_namelen = sizeof(*dest_addr);
+    send_msgs[i].msg_hdr.msg_iov = send_iovs[i];
+    send_msgs[i].msg_hdr.msg_iovlen = 1;
+}
+
+// Funktion zum Senden der Paritätspakete des aktuellen Blocks und Beginnen des nächsten Blocks
+void sendParity(int sock, struct sockaddr_in6 *dest_addr, float error_rate) {
+    int count = block_fill < fec_parity ? block_fill : fec_parity;  // Klassen ohne Datenpaket entfallen
+    for (int j = 0; j < count; j++) {
+        struct parity_packet *parity = &parity_packets[j];
+        parity->fec.index = (uint8_t)j;
+        parity->fec.stride = (uint8_t)fec_parity;
+        parity->fec.count = htons((uint16_t)block_fill);
+        parity->fec.length_xor = htons(parity->length_xor);
+        parity->fec.reserved = 0;
+        fillHeader(&parity->header, PKT_PARITY, 0, session_id, block_start, &parity->fec,
+                   (uint16_t)(FEC_HEADER_SIZE + parity->data_len));
+
+        // Paritätspakete unterliegen derselben simulierten Fehlerquote wie Datenpakete
+        if ((float)rand() / RAND_MAX < error_rate) {
+            printf("Parity packet %d of block %u dropped due to simulated error\n", j, block_start);
+            continue;
+        }
+        queueParityPacket(sock, dest_addr, parity);
+    }
+    printf("Sent parity for block %u (%d data packets).\n", block_start, block_fill);
+
+    // Die Paritätspuffer werden für den nächsten Block wiederverwendet, daher sofort senden
+    flushPackets(sock);
+    resetParity(block_start + block_fill);
+}
+
+// Funktion zum Einrechnen eines neuen Datenpakets in die Parität seines Blocks.
+// Ist der Block voll, werden seine Paritätspakete direkt hinter dem letzten Datenpaket gesendet.
+void encodeParity(int sock, struct sockaddr_in6 *dest_addr, const char *data, int data_len, float error_rate) {
+    struct parity_packet *parity = &parity_packets[block_fill % fec_parity];
+    if (data_len > parity->data_len) {
+        memset(parity->data + parity->data_len, 0, data_len - parity->data_len);
+        parity->data_len = data_len;
+    }
+    xorBytes(parity->data, (const uint8_t *)data, data_len);
+    parity->length_xor ^= (uint16_t)data_len;
+
+    if (++block_fill == fec_data) {
+        sendParity(sock, dest_addr, error_rate);
+    }
+}
+
+// Funktion zum erneuten Senden eines gepufferten Pakets (SR-Protokollschicht)
+void resendPacket(int sock, struct sockaddr_in6 *dest_addr, uint32_t seq_num) {
+    struct send_slot *slot = sendSlot(seq_num);
+    queuePacket(sock, dest_addr, seq_num);
+    slot->resend_time = nowMicros();
+    slot->simulated_loss = 0;
+    consumeTokens(HEADER_SIZE + slot->length, 0);
+    printf("Resent packet %u\n", seq_num);
+}
+
+// Funktion zum Weiterdrehen des Timer-Rads bis zur aktuellen Zeit.
+// Abgelaufene Timer lösen eine erneute Übertragung ihres Pakets aus und werden neu gestartet.
+// Der RTO wird höchstens einmal pro RTO verdoppelt, auch wenn viele Timer gleichzeitig ablaufen.
+void processExpiredTimers(int sock, struct sockaddr_in6 *dest_addr, uint32_t next_seq) {
+    long long now = nowMicros();
+
+    while (wheel_time + WHEEL_TICK <= now) {
+        wheel_time += WHEEL_TICK;
+        wheel_cursor = (wheel_cursor + 1) % WHEEL_SLOTS;
+
+        struct retransmit_timer *timer = wheel[wheel_cursor];
+        while (timer) {
+            struct retransmit_timer *next = timer->next;
+            if (timer->rounds > 0) {
+                timer->rounds--;
+            } else {
+                // Nach einem Timeout ist ein ACK nicht eindeutig zuordenbar (Karn-Algorithmus)
+                printf("Timeout for packet %u. Resending...\n", timer->seq_num);
+                if (now - last_backoff >= rto) {
+                    backoffRto();
+                    last_backoff = now;
+                }
+                congestionLoss(timer->seq_num, next_seq, 1);
+                resendPacket(sock, dest_addr, timer->seq_num);
+                sendSlot(timer->seq_num)->rtt_sample_valid = 0;
+                armTimer(timer->seq_num, rto);
+            }
+            timer = next;
+        }
+    }
+}
+
+// Funktion zum Neubewerten eines Pakets nach einer Bestätigung oder dem Ausscheiden eines Empfängers.
+// Haben alle teilnehmenden Empfänger bestätigt, wird nicht mehr wiederholt; für das Verschieben
+// des Fensters genügen requiredAcks() Bestätigungen.
+void updateSlotState(uint32_t seq_num) {
+    struct send_slot *slot = sendSlot(seq_num);
+    uint64_t acked_by = slot->ack_mask & alive_mask;
+    if (acked_by == alive_mask) {
+        cancelTimer(seq_num);
+    }
+    slot->acked = __builtin_popcountll(acked_by) >= requiredAcks();
+}
+
+// Funktion zum Bestimmen des ältesten Pakets, das Empfänger r noch anfordern kann. Im Quorum-Modus
+// kann ein Empfänger hinter dem Fensteranfang zurückliegen; seine Pakete bleiben im Ringpuffer,
+// bis der Slot für ein neues Paket gebraucht wird.
+uint32_t receiverFloor(int r, uint32_t base) {
+    return seqLess(receivers[r].next_expected, base) ? receivers[r].next_expected : base;
+}
+
+// Funktion zum Entfernen eines Empfängers aus der Übertragung (ausgefallen oder hinter dem Quorum zurückgeblieben)
+void dropReceiver(int r, const char *reason, uint32_t base, uint32_t next_seq) {
+    uint32_t floor = receiverFloor(r, base);
+    receivers[r].alive = 0;
+    alive_mask &= ~(1ULL << r);
+    printf("Receiver %s dropped at packet %u: %s.\n", receivers[r].name, receivers[r].next_expected, reason);
+
+    // Pakete, auf deren Bestätigung nur noch dieser Empfänger fehlte, sind nun erledigt
+    for (uint32_t seq = floor; seq != next_seq; seq++) {
+        updateSlotState(seq);
+    }
+}
+
+// Funktion zum Entfernen von Empfängern, die seit RECEIVER_TIMEOUT auf keine Übertragung geantwortet haben.
+// Gemessen wird ab der ersten Übertragung nach der letzten Rückmeldung, nicht ab der Rückmeldung selbst,
+// damit Pausen des Senders (z. B. ein langer RTO) nicht als Ausfall gelten.
+void checkReceiverTimeouts(uint32_t base, uint32_t next_seq) {
+    long long now = nowMicros();
+    for (int r = 0; r < receiver_count; r++) {
+        struct receiver *receiver = &receivers[r];
+        if (!receiver->alive) {
+            continue;
+        }
+        if (receiver->waiting_since == 0 && last_transmit > receiver->last_heard) {
+            receiver->waiting_since = last_transmit;
+        }
+        if (receiver->waiting_since != 0 && now - receiver->waiting_since > RECEIVER_TIMEOUT) {
+            dropReceiver(r, "no feedback", base, next_seq);
+        }
+    }
+}
+
+// Funktion zum Verschieben des Fensters über alle Pakete, die genug Empfänger bestätigt haben.
+// Der Timer eines Pakets läuft weiter, bis auch zurückliegende Empfänger es bestätigt haben (updateSlotState).
+void slideWindow(uint32_t *base, uint32_t next_seq) {
+    uint32_t old_base = *base;
+    while (*base != next_seq && sendSlot(*base)->acked) {
+        (*base)++;
+    }
+    if (*base != old_base) {
+        congestionAck((int)(*base - old_base));
+    }
+}
+
+// Funktion zur Prüfung, ob ein zurückliegender Empfänger das Paket im Slot von next_seq noch braucht
+int slotNeededByLaggard(uint32_t next_seq) {
+    for (int r = 0; r < receiver_count; r++) {
+        if (receivers[r].alive && next_seq - receivers[r].next_expected > (uint32_t)ring_mask) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Funktion zum Entfernen von Empfängern, deren ältestes fehlendes Paket im Slot von next_seq liegt.
+// Der Slot wird gleich für next_seq überschrieben, danach könnten sie das Paket nicht mehr erhalten.
+void dropLaggingReceivers(uint32_t base, uint32_t next_seq) {
+    for (int r = 0; r < receiver_count; r++) {
+        if (receivers[r].alive && next_seq - receivers[r].next_expected > (uint32_t)ring_mask) {
+            dropReceiver(r, "fell behind the quorum", base, next_seq);
+        }
+    }
+}
+
+// Funktion zur Prüfung, ob alle teilnehmenden Empfänger jedes gesendete Paket bestätigt haben
+int allReceiversCaughtUp(uint32_t next_seq) {
+    for (int r = 0; r < receiver_count; r++) {
+        if (receivers[r].alive && receivers[r].next_expected != next_seq) {
+            return 0;
+        }
+    }
+    return 1;
+}
 
-        int activity = select(sock + 1, &readfds, NULL, NULL, &interval);
+// Funktion zur Verarbeitung der Anforderung eines einzelnen Pakets durch Empfänger r
+void handleNack(int sock, struct sockaddr_in6 *dest_addr, int r, uint32_t nack_seq, uint32_t base, uint32_t next_seq) {
+    if (!seqInRange(nack_seq, receiverFloor(r, base), next_seq) || (sendSlot(nack_seq)->ack_mask & (1ULL << r))) {
+        return;
+    }
 
-        if (activity < 0) {
-            perror("select");
+    // NACKs mehrerer Empfänger für dasselbe Paket innerhalb einer RTT lösen nur eine Wiederholung aus
+    struct send_slot *slot = sendSlot(nack_seq);
+    long long window = rtt_measured ? srtt : rto;
+    if (slot->resend_time != 0 && nowMicros() - slot->resend_time < window) {
+        printf("Received NACK for packet %u from %s, coalesced.\n", nack_seq, receivers[r].name);
+        return;
+    }
+
+    printf("Received NACK for packet %u from %s. Resending...\n", nack_seq, receivers[r].name);
+    congestionLoss(nack_seq, next_seq, 0);
+
+    // Der Empfänger meldet das Original als verloren, daher misst das ACK
+    // der NACK-ausgelösten Wiederholung wieder eine gültige RTT
+    resendPacket(sock, dest_addr, nack_seq);
+    slot->send_time = nowMicros();
+    slot->rtt_sample_valid = 1;
+    armTimer(nack_seq, rto);
+}
+
+// Funktion zum Vermerken der Bestätigung eines Pakets durch Empfänger r, gibt 1 zurück, wenn sie neu ist
+int ackPacket(int r, uint32_t seq_num) {
+    struct send_slot *slot = sendSlot(seq_num);
+    if (slot->ack_mask & (1ULL << r)) {
+        return 0;
+    }
+    slot->ack_mask |= 1ULL << r;
+    updateSlotState(seq_num);
+    return 1;
+}
+
+// Funktion zur Verarbeitung einer kumulativen Bestätigung mit optionaler SACK-Bitmaske von Empfänger r.
+// Die RTT wird nur am jüngsten neu bestätigten Paket gemessen, ältere wären um die ACK-Verzögerung verfälscht.
+void handleAck(int r, uint32_t cumulative, const uint8_t *bitmap, int bitmap_len, uint32_t base, uint32_t next_seq) {
+    struct receiver *receiver = &receivers[r];
+    uint32_t floor = receiverFloor(r, base);
+
+    // Veraltete Bestätigungen vor dem Fenster bzw. vor dem Rückstand des Empfängers und ungültige dahinter ignorieren
+    if (!seqInRange(cumulative, floor, next_seq + 1)) {
+        return;
+    }
+
+    int sampled = 0;          // Gibt an, ob newest gesetzt ist
+    uint32_t newest = 0;      // Jüngstes durch diese Rückmeldung neu bestätigtes Paket
+    for (uint32_t seq = receiver->next_expected; seqLess(seq, cumulative); seq++) {
+        if (ackPacket(r, seq)) {
+            newest = seq;
+            sampled = 1;
+        }
+    }
+    for (int bit = 0; bit < bitmap_len * 8; bit++) {
+        uint32_t seq = cumulative + 1 + bit;
+        if (!seqInRange(seq, floor, next_seq)) {
             break;
         }
+        if (bitmapTest(bitmap, bit) && ackPacket(r, seq)) {
+            newest = seq;
+            sampled = 1;
+        }
+    }
+    if (sampled && sendSlot(newest)->rtt_sample_valid) {
+        updateRtt(nowMicros() - sendSlot(newest)->send_time);
+    }
+
+    // Lückenlos bestätigten Bereich dieses Empfängers nachziehen
+    while (receiver->next_expected != next_seq && (sendSlot(receiver->next_expected)->ack_mask & (1ULL << r))) {
+        receiver->next_expected++;
+    }
+    if (sampled) {
+        printf("Received ACK up to packet %u from %s.\n", receiver->next_expected, receiver->name);
+    }
+}
+
+// Funktion zur Verarbeitung einer Rückmeldung eines Empfängers (ACK/NACK)
+void handleFeedback(int sock, struct sockaddr_in6 *dest_addr, const struct packet_header *header, const char *payload,
+                    const struct sockaddr_in6 *src_addr, uint32_t base, uint32_t next_seq) {
+    int r = findReceiver(src_addr);
+    if (r < 0 || !receivers[r].alive) {
+        if (header->type == PKT_HELLO_ACK) {
+            printf("Late HELLO ACK ignored, registration is closed.\n");
+        }
+        return;  // Unbekannter oder bereits ausgeschiedener Empfänger
+    }
+    receivers[r].last_heard = nowMicros();
+    receivers[r].waiting_since = 0;
+
+    if (header->type == PKT_ACK) {
+        // Kumulatives ACK, die Nutzdaten sind die SACK-Bitmaske
+        if (header->length <= SACK_BITMAP_BYTES) {
+            handleAck(r, header->seq_num, (const uint8_t *)payload, header->length, base, next_seq);
+        }
+    } else if (header->type == PKT_NACK) {
+        // NACK mit kumulativer Bestätigung und optionaler Bitmaske: alle gemeldeten Pakete
+        // werden gemeinsam im nächsten sendmmsg() wiederholt
+        if (header->length < NACK_ACK_SIZE || header->length > NACK_ACK_SIZE + NACK_BITMAP_BYTES) {
+            return;
+        }
+        uint32_t cumulative;
+        memcpy(&cumulative, payload, NACK_ACK_SIZE);
+        handleAck(r, ntohl(cumulative), NULL, 0, base, next_seq);
+
+        const uint8_t *bitmap = (const uint8_t *)payload + NACK_ACK_SIZE;
+        handleNack(sock, dest_addr, r, header->seq_num, base, next_seq);
+        for (int bit = 0; bit < (header->length - NACK_ACK_SIZE) * 8; bit++) {
+            if (bitmapTest(bitmap, bit)) {
+                handleNack(sock, dest_addr, r, header->seq_num + 1 + bit, base, next_seq);
+            }
+        }
+    }
+}
+
+// Funktion zum vollständigen Abholen aller anstehenden Rückmeldungen. Bei flankengesteuertem
+// epoll muss der Socket geleert werden, bis recvmmsg() weniger als RECV_BATCH Pakete liefert.
+void drainFeedback(int sock, struct sockaddr_in6 *dest_addr, uint32_t base, uint32_t next_seq) {
+    while (1) {
+        for (int i = 0; i < RECV_BATCH; i++) {
+            recv_msgs[i].msg_hdr.msg_namelen = sizeof(recv_addrs[i]);
+        }
+        int count = recvmmsg(sock, recv_msgs, RECV_BATCH, MSG_DONTWAIT, NULL);
+        if (count < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("recvmmsg");
+            }
+            return;
+        }
+
+        for (int i = 0; i < count; i++) {
+            struct packet_header header;
+            const char *payload;
+
+            if (parsePacket(recv_buffers[i], (int)recv_msgs[i].msg_len, &header, &payload) < 0) {
+                printf("Malformed packet (%u bytes) ignored.\n", recv_msgs[i].msg_len);
+                continue;
+            }
+            if (header.session_id != session_id) {
+                continue;  // Rückmeldung für eine andere Übertragung
+            }
+            handleFeedback(sock, dest_addr, &header, payload, &recv_addrs[i], base, next_seq);
+        }
+
+        if (count < RECV_BATCH) {
+            return;
+        }
+    }
+}
+
+// Verwaltung von Timern und Ereignissen (SR-Protokollschicht)
+// Hält bis zu window_size unbestätigte Pakete gleichzeitig im Netz und wartet nur,
+// wenn das Fenster voll ist oder die Datei vollständig gesendet wurde. Jedes Paket
+// besitzt einen eigenen Retransmissions-Timer im Timer-Rad.
+// Gibt -1 zurück, wenn weniger Empfänger übrig sind, als das Quorum verlangt.
+int manageTimersAndEvents(int sock, struct sockaddr_in6 *dest_addr, int window_size, float error_rate) {
+    struct epoll_event events[MAX_EVENTS];  // Von epoll_wait() gemeldete Ereignisse
+    int timer_fd;                        // timerfd für Retransmissions-Timer und Pacing
+    const char *data;                    // Nächste Nutzdaten
+    int data_len;                        // Länge der nächsten Nutzdaten
+    uint32_t base = initial_seq;         // Älteste unbestätigte Sequenznummer (Fensteranfang)
+    uint32_t next_seq = initial_seq;     // Nächste zu vergebende Sequenznummer
+    int eof_reached = 0;                 // Gibt an, ob die Datei vollständig gelesen wurde
+    int result = 0;                      // Rückgabewert
+    long long next_send_time = 0;        // Frühester Zeitpunkt für das nächste neue Paket (Pacing)
+    int zc_blocked = 0;                  // Nächster Slot wartet auf eine Zero-Copy-Abschlussmeldung (EPOLLERR)
+    long long zc_blocked_since = 0;      // Beginn des Wartens auf die Abschlussmeldung, 0 wenn keins
+    int input_blocked = 0;               // stdin liefert gerade nicht genug Daten für das nächste Paket
+    int lag_blocked = 0;                 // Nächster Slot enthält noch ein Paket für einen zurückliegenden Empfänger
+    long long lag_blocked_since = 0;     // Beginn des Wartens auf den zurückliegenden Empfänger, 0 wenn keins
+
+    max_window = window_size;
+    cwnd = INITIAL_CWND < window_size ? INITIAL_CWND : window_size;
+    ssthresh = window_size;
+    recovery_seq = initial_seq;
+    token_time = nowMicros();
+    initSendRing(window_size);
+    initTimerWheel();
+    if (fec_data > 0) {
+        parity_packets = malloc(fec_parity * sizeof(struct parity_packet));
+        if (!parity_packets) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        resetParity(initial_seq);
+    }
+    initReceiveBatch();
+    int epoll_fd = initEventLoop(sock, &timer_fd);
+
+    // stdin wird einmalig (EPOLLONESHOT) beobachtet und nur neu angemeldet, wenn auf Daten gewartet wird
+    struct epoll_event stdin_event;
+    memset(&stdin_event, 0, sizeof(stdin_event));
+    stdin_event.events = EPOLLIN | EPOLLONESHOT;
+    stdin_event.data.fd = STDIN_FILENO;
+    int stdin_registered = 0;            // stdin ist bei epoll angemeldet
 
-        if (activity == 0) { // Timer abgelaufen
-            timeout_count++;
-            if (timeout_count >= 3) { // Nach 3 Intervallen weiter
-                printf("Timeout: Moving to next packet...\n");
-                timeout_count = 0;
+    while (1) {
+        // Fenster auffüllen, solange Überlastfenster und Token-Bucket es erlauben
+        zc_blocked = 0;
+        input_blocked = 0;
+        lag_blocked = 0;
+        while (!eof_reached && next_seq - base < sendWindow()) {
+            next_send_time = pacingDeadline();
+            if (next_send_time > nowMicros()) {
+                break;
+            }
+
+            // Der Kopf im Ringpuffer darf erst überschrieben werden, wenn der Kernel ihn nicht mehr liest
+            if (sendSlot(next_seq)->zc_pending > 0) {
+                reapCompletions(sock);
+                if (sendSlot(next_seq)->zc_pending > 0) {
+                    long long waited_since = zc_blocked_since ? zc_blocked_since : nowMicros();
+                    if (nowMicros() - waited_since < ZC_SLOT_TIMEOUT) {
+                        zc_blocked_since = waited_since;
+                        zc_blocked = 1;
+                        break;
+                    }
+                    abandonZerocopy();
+                }
+            }
+            zc_blocked_since = 0;
 
-                if (readFileLine(file, buffer, BUF_SIZE)) {
-                    sendPacket(sock, dest_addr, seq_num, buffer, error_rate);
-                    seq_num++;
-                } else {
-                    printf("End of file reached.\n");
+            // Ein zurückliegender Empfänger bekommt höchstens ein RTO Zeit, den Slot freizugeben
+            if (slotNeededByLaggard(next_seq)) {
+                long long waited_since = lag_blocked_since ? lag_blocked_since : nowMicros();
+                if (nowMicros() - waited_since < rto) {
+                    lag_blocked_since = waited_since;
+                    lag_blocked = 1;
                     break;
                 }
+                dropLaggingReceivers(base, next_seq);
             }
-        } else if (FD_ISSET(sock, &readfds)) { // Datenempfang
-            char recv_buffer[BUF_SIZE];
-            struct sockaddr_in6 src_addr;
-            socklen_t src_addr_len = sizeof(src_addr);
-
-            ssize_t len = recvfrom(sock, recv_buffer, sizeof(recv_buffer) - 1, 0,
-                                   (struct sockaddr *)&src_addr, &src_addr_len);
-            if (len > 0) {
-                recv_buffer[len] = '\0';
-                if (strncmp(recv_buffer, "NACK:", 5) == 0) {
-                    int nack_seq = atoi(recv_buffer + 5);
-                    printf("Received NACK for packet %d. Resending...\n", nack_seq);
-
-                    if (nack_seq >= 0 && nack_seq < MAX_SEQ_NUM && packet_lengths[nack_seq] > 0) {
-                        sendto(sock, sent_packets[nack_seq], packet_lengths[nack_seq], 0,
-                               (struct sockaddr *)dest_addr, sizeof(*dest_addr));
-                        timeout_count = 0; // Timeout-Zähler zurücksetzen
-                    }
+            lag_blocked_since = 0;
+            if ((data_len = readNextPayload(next_seq, next_seq == base, &data)) > 0) {
+                sendPacket(sock, dest_addr, next_seq, data, data_len, error_rate);
+                if (fec_data > 0) {
+                    encodeParity(sock, dest_addr, data, data_len, error_rate);
+                }
+                armTimer(next_seq, rto);
+                next_seq++;
+            } else if (data_len < 0) {
+                input_blocked = 1;  // Auf weitere Daten von stdin oder ein ACK warten
+                break;
+            } else {
+                printf("End of file reached.\n");
+                eof_reached = 1;
+                if (fec_data > 0 && block_fill > 0) {
+                    sendParity(sock, dest_addr, error_rate);  // Unvollständiger letzter Block
+                }
+            }
+        }
+
+        // Alle neu freigegebenen Pakete des Fensters mit einem Aufruf senden
+        flushPackets(sock);
+
+        // Übertragung beendet, sobald alle gesendeten Pakete bestätigt sind und kein Empfänger mehr zurückliegt
+        if (eof_reached && base == next_seq && allReceiversCaughtUp(next_seq)) {
+            printf("All packets acknowledged.\n");
+            break;
+        }
+
+        // Schlafen bis zum nächsten belegten Slot des Timer-Rads bzw. zum nächsten Sendezeitpunkt
+        long long now = nowMicros();
+        long long deadline = nextWheelDeadline();
+        if (!eof_reached && !zc_blocked && !input_blocked && !lag_blocked && next_seq - base < sendWindow() &&
+            (deadline < 0 || next_send_time < deadline)) {
+            deadline = next_send_time;
+        }
+        if (zc_blocked && (deadline < 0 || zc_blocked_since + ZC_SLOT_TIMEOUT < deadline)) {
+            deadline = zc_blocked_since + ZC_SLOT_TIMEOUT;  // Nicht unbegrenzt auf die Abschlussmeldung warten
+        }
+        if (lag_blocked && (deadline < 0 || lag_blocked_since + rto < deadline)) {
+            deadline = lag_blocked_since + rto;  // Danach wird der zurückliegende Empfänger entfernt
+        }
+
+        int timeout = -1;
+        if (deadline >= 0 && deadline <= now) {
+            timeout = 0;  // Ereignis ist bereits fällig
+        } else if (deadline >= 0) {
+            setTimerFd(timer_fd, deadline);
+        }
+
+        if (input_blocked && stream_pollable) {
+            if (epoll_ctl(epoll_fd, stdin_registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, STDIN_FILENO, &stdin_event) < 0) {
+                perror("epoll_ctl (stdin)");
+                exit(EXIT_FAILURE);
+            }
+            stdin_registered = 1;
+        }
+
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == timer_fd) {
+                uint64_t expirations;
+                if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+                    perror("read (timerfd)");
                 }
+            } else if (events[i].data.fd == sock) { // Datenempfang
+                if (events[i].events & EPOLLERR) {
+                    reapCompletions(sock);  // Zero-Copy-Abschlussmeldungen
+                }
+                drainFeedback(sock, dest_addr, base, next_seq);
             }
         }
 
-        // Intervall zurücksetzen
-        interval.tv_sec = 0;
-        interval.tv_usec = DEFAULT_INTERVAL;
+        // Empfänger ohne Rückmeldung entfernen und das Fenster über alle zusammenhängend bestätigten Pakete verschieben
+        checkReceiverTimeouts(base, next_seq);
+        slideWindow(&base, next_seq);
+        if (alive_mask == 0 || __builtin_popcountll(alive_mask) < requiredAcks()) {
+            fprintf(stderr, "Not enough receivers left, aborting transfer.\n");
+            result = -1;
+            break;
+        }
+
+        // Abgelaufene Retransmissions-Timer verarbeiten
+        processExpiredTimers(sock, dest_addr, next_seq);
+
+        // Durch NACKs und Timeouts ausgelöste Wiederholungen gemeinsam senden
+        flushPackets(sock);
     }
+
+    close(timer_fd);
+    close(epoll_fd);
+    drainCompletions(sock);
+    freeSendRing();
+    free(parity_packets);
+    parity_packets = NULL;
+    return result;
 }
 
 int main(int argc, char *argv[]) {
+    // Optionen einlesen
+    int opt;
+    while ((opt = getopt(argc, argv, "bs:i:n:q:e:r:z")) != -1) {
+        switch (opt) {
+            case 'b':
+                binary_mode = 1;
+                break;
+            case 's':
+                chunk_size = atoi(optarg);
+                break;
+            case 'i':
+                initial_seq = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                expected_receivers = atoi(optarg);
+                break;
+            case 'q':
+                quorum = atoi(optarg);
+                break;
+            case 'e':
+                if (sscanf(optarg, "%d:%d", &fec_data, &fec_parity) != 2) {
+                    usage();
+                }
+                break;
+            case 'r':
+                max_rate = parseRate(optarg);
+                break;
+            case 'z':
+                zerocopy = 1;
+                break;
+            default:
+                usage();
+        }
+    }
+
     // Überprüfung der Argumentanzahl
-    if (argc != 6) {
+    if (argc - optind != 5) {
         usage();
         exit(EXIT_FAILURE);
     }
 
     // Argumente einlesen
-    char *filename = argv[1];           // Name der zu sendenden Datei
-    char *multicast_addr = argv[2];     // IPv6-Multicast-Adresse
-    int port = atoi(argv[3]);           // Zielport
-    int window_size = atoi(argv[4]);    // Fenstergröße (1 bis MAX_WINDOW_SIZE)
-    float error_rate = atof(argv[5]);   // Fehlerquote
+    char *filename = argv[optind];              // Name der zu sendenden Datei
+    char *multicast_addr = argv[optind + 1];    // IPv6-Multicast-Adresse
+    int port = atoi(argv[optind + 2]);          // Zielport
+    int window_size = atoi(argv[optind + 3]);   // Fenstergröße (1 bis MAX_WINDOW_SIZE)
+    float error_rate = atof(argv[optind + 4]);  // Fehlerquote
+
+    // Überprüfung der FEC-Parameter; Paritätspakete brauchen Platz für ihren fec_header
+    if (fec_data != 0 || fec_parity != 0) {
+        if (fec_data < 1 || fec_data > FEC_MAX_DATA || fec_parity < 1 || fec_parity > fec_data ||
+            fec_parity > FEC_MAX_PARITY) {
+            fprintf(stderr, "FEC needs 1 <= k <= n <= %d and k <= %d.\n", FEC_MAX_DATA, FEC_MAX_PARITY);
+            exit(EXIT_FAILURE);
+        }
+        max_line = FEC_MAX_DATA_PAYLOAD;
+    }
+
+    // Überprüfung der Blockgröße
+    int max_chunk = fec_data > 0 ? FEC_MAX_DATA_PAYLOAD : MAX_PAYLOAD;
+    if (chunk_size < 1 || chunk_size > max_chunk) {
+        fprintf(stderr, "Chunk size must be between 1 and %d.\n", max_chunk);
+        exit(EXIT_FAILURE);
+    }
+
+    // Überprüfung der Empfängerzahlen
+    if (expected_receivers < 0 || expected_receivers > MAX_RECEIVERS || quorum < 0 || quorum > MAX_RECEIVERS) {
+        fprintf(stderr, "Receiver count and quorum must be between 0 and %d.\n", MAX_RECEIVERS);
+        exit(EXIT_FAILURE);
+    }
 
     // Überprüfung der Fenstergröße
     if (window_size < 1 || window_size > MAX_WINDOW_SIZE) {
@@ -242,24 +1960,31 @@ int main(int argc, char *argv[]) {
     // Initialisiert den Socket für den Multicast-Versand
     int sock = initializeSenderSocket(multicast_addr, port, &dest_addr);
 
-    // Öffnet die Datei im Lese-Modus
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        perror("fopen");
-        close(sock);
-        exit(EXIT_FAILURE);
+    // Blendet die Datei zum Lesen in den Speicher ein bzw. bereitet stdin vor
+    if (strcmp(filename, "-") == 0) {
+        openInputStream();
+    } else {
+        mapInputFile(filename);
+    }
+
+    // Zufällige Sitzungskennung, damit der Empfänger gleichzeitige Sender unterscheiden kann
+    if (getrandom(&session_id, sizeof(session_id), 0) != sizeof(session_id)) {
+        session_id = (uint32_t)(nowMicros() ^ getpid());
     }
+    printf("Session ID: %08x\n", session_id);
 
     // Verbindungsaufbau
     establishConnection(sock, &dest_addr);
 
     // Verwaltung von Timern und Ereignissen
-    manageTimersAndEvents(sock, file, &dest_addr, error_rate);
+    int result = manageTimersAndEvents(sock, &dest_addr, window_size, error_rate);
 
     // Verbindungsabbau
     terminateConnection(sock, &dest_addr);
+    printReceiverSummary(result == 0);
 
-    fclose(file);  // Schließt die Datei
+    unmapInputFile();  // Gibt die eingeblendete Datei frei
+    closeInputStream();
     close(sock);   // Schließt den Socket
-    return 0;      // Beendet das Programm
+    return result < 0 ? EXIT_FAILURE : 0;  // Beendet das Programm
 }
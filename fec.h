@@ -0,0 +1,93 @@
+/* fec.h */
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "protocol.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Vorwärtsfehlerkorrektur mit verschränkter XOR-Parität: Zu jedem Block aus n Datenpaketen
+// sendet der Sender k Paritätspakete. Paritätspaket j ist das XOR aller Datenpakete des Blocks,
+// deren Position i die Bedingung i % k == j erfüllt. Pro Paritätsklasse kann der Empfänger ein
+// verlorenes Paket ohne Rückfrage wiederherstellen, eine Verlustserie von bis zu k Paketen also vollständig.
+#define FEC_MAX_DATA 64           // Maximale Anzahl an Datenpaketen pro Block (Bitmaske)
+#define FEC_MAX_PARITY 16         // Maximale Anzahl an Paritätspaketen pro Block
+
+// Nutzdaten des HELLO bei gesetztem PKT_FLAG_FEC
+struct fec_params {
+    uint8_t data_count;           // n: Datenpakete pro Block
+    uint8_t parity_count;         // k: Paritätspakete pro Block
+    uint16_t max_payload;         // Größte Nutzdatenlänge eines Datenpakets (Netzwerk-Byte-Reihenfolge)
+};
+
+// Beginn der Nutzdaten eines Paritätspakets, danach folgt das XOR der Nutzdaten.
+// Der Paketkopf trägt als seq_num die erste Sequenznummer des Blocks.
+struct fec_header {
+    uint8_t index;                // Nummer j des Paritätspakets im Block
+    uint8_t stride;               // k, Abstand der abgedeckten Positionen
+    uint16_t count;               // Anzahl der Datenpakete im Block (am Dateiende ggf. kleiner als n)
+    uint16_t length_xor;          // XOR der Nutzdatenlängen der abgedeckten Pakete
+    uint16_t reserved;            // Immer 0
+};
+
+#define FEC_HEADER_SIZE ((int)sizeof(struct fec_header))
+#define FEC_MAX_DATA_PAYLOAD (MAX_PAYLOAD - FEC_HEADER_SIZE)  // Datenpakete dürfen im FEC-Modus nicht größer sein
+
+#if defined(__x86_64__) || defined(__i386__)
+// Funktion zum XOR-Verknüpfen zweier Puffer mit 256-Bit-Registern (AVX2)
+static inline __attribute__((target("avx2"))) void xorBytesAvx2(uint8_t *dst, const uint8_t *src, size_t len) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_xor_si256(a, b));
+    }
+    for (; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+// Funktion zum XOR-Verknüpfen zweier Puffer mit 128-Bit-Registern (SSE2)
+static inline __attribute__((target("sse2"))) void xorBytesSse2(uint8_t *dst, const uint8_t *src, size_t len) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_xor_si128(a, b));
+    }
+    for (; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+}
+#endif
+
+// Funktion zum XOR-Verknüpfen von src in dst. Die Befehlssatzerweiterung wird zur Laufzeit gewählt,
+// damit dasselbe Programm auch auf Prozessoren ohne AVX2 läuft.
+static inline void xorBytes(uint8_t *dst, const uint8_t *src, size_t len) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        xorBytesAvx2(dst, src, len);
+    } else {
+        xorBytesSse2(dst, src, len);
+    }
+#else
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t a, b;
+        memcpy(&a, dst + i, 8);
+        memcpy(&b, src + i, 8);
+        a ^= b;
+        memcpy(dst + i, &a, 8);
+    }
+    for (; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+#endif
+}
+
+#endif
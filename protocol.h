@@ -0,0 +1,181 @@
+/* protocol.h */
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#define PROTOCOL_VERSION 2        // Version des Paketformats
+#define MAX_PAYLOAD 8192          // Maximale Größe der Nutzdaten eines Pakets
+
+// Pakettypen für Kontroll- und Datenpakete
+enum packet_type {
+    PKT_HELLO = 1,                // Verbindungsaufbau (Sender -> Empfänger)
+    PKT_HELLO_ACK,                // Bestätigung des Verbindungsaufbaus
+    PKT_CLOSE,                    // Verbindungsabbau (Sender -> Empfänger)
+    PKT_CLOSE_ACK,                // Bestätigung des Verbindungsabbaus
+    PKT_DATA,                     // Datenpaket mit Nutzdaten
+    PKT_ACK,                      // Bestätigung eines Datenpakets
+    PKT_NACK,                     // Anforderung eines fehlenden Datenpakets
+    PKT_PARITY                    // Paritätspaket zur Vorwärtsfehlerkorrektur (siehe fec.h)
+};
+
+// Flags im Paketkopf
+#define PKT_FLAG_BINARY 0x01      // HELLO: Nutzdaten sind Binärblöcke und werden unverändert geschrieben
+#define PKT_FLAG_FEC 0x02         // HELLO: Sender schickt Paritätspakete, Nutzdaten sind struct fec_params
+
+// Bestätigungen sind kumulativ: Ein ACK mit seq_num bestätigt alle Pakete vor seq_num. Optional folgt
+// als Nutzdaten eine SACK-Bitmaske bereits vorgezogen empfangener Pakete.
+// Ein NACK fordert seq_num an. Die Nutzdaten beginnen mit der kumulativen Bestätigung des Empfängers
+// (4 Bytes, Netzwerk-Byte-Reihenfolge), danach folgt optional eine Bitmaske weiterer fehlender Pakete.
+// In beiden Bitmasken steht Bit i (Byte i / 8, Wert 1 << (i % 8)) für seq_num + 1 + i.
+#define SACK_BITMAP_BITS 1024     // Anzahl der Folgepakete, die ein ACK selektiv bestätigen kann
+#define SACK_BITMAP_BYTES (SACK_BITMAP_BITS / 8)
+#define NACK_BITMAP_BITS 256      // Anzahl der Folgepakete, die ein NACK zusätzlich anfordern kann
+#define NACK_BITMAP_BYTES (NACK_BITMAP_BITS / 8)
+#define NACK_ACK_SIZE 4           // Länge der kumulativen Bestätigung am Anfang eines NACKs
+
+// Fester Paketkopf, alle Felder in Netzwerk-Byte-Reihenfolge (16 Bytes)
+struct packet_header {
+    uint8_t version;              // Version des Paketformats
+    uint8_t type;                 // Pakettyp (enum packet_type)
+    uint8_t flags;                // Typabhängige Optionen (PKT_FLAG_*)
+    uint8_t reserved;             // Immer 0
+    uint32_t seq_num;             // Sequenznummer
+    uint32_t session_id;          // Vom Sender gewählte Kennung der Übertragung
+    uint16_t length;              // Länge der Nutzdaten in Bytes
+    uint16_t checksum;            // Internet-Prüfsumme über Kopf und Nutzdaten
+};
+
+#define HEADER_SIZE ((int)sizeof(struct packet_header))
+#define MAX_PACKET_SIZE (HEADER_SIZE + MAX_PAYLOAD)
+
+// Blockgröße, mit der ein Paket ohne Fragmentierung in jedes IPv6-Datagramm passt
+// (minimale IPv6-MTU abzüglich IPv6-Kopf, UDP-Kopf und Paketkopf)
+#define IPV6_MIN_MTU 1280
+#define DEFAULT_CHUNK_SIZE (IPV6_MIN_MTU - 40 - 8 - HEADER_SIZE)
+
+// Funktion zur Ausgabe des Namens eines Pakettyps
+static inline const char *packetTypeName(uint8_t type) {
+    switch (type) {
+        case PKT_HELLO:     return "HELLO";
+        case PKT_HELLO_ACK: return "HELLO ACK";
+        case PKT_CLOSE:     return "CLOSE";
+        case PKT_CLOSE_ACK: return "CLOSE ACK";
+        case PKT_DATA:      return "DATA";
+        case PKT_ACK:       return "ACK";
+        case PKT_NACK:      return "NACK";
+        case PKT_PARITY:    return "PARITY";
+        default:            return "UNKNOWN";
+    }
+}
+
+// Funktion zum Setzen eines Bits in der Bitmaske eines ACKs oder NACKs
+static inline void bitmapSet(uint8_t *bitmap, int bit) {
+    bitmap[bit / 8] |= (uint8_t)(1 << (bit % 8));
+}
+
+// Funktion zur Prüfung, ob ein Bit in der Bitmaske eines ACKs oder NACKs gesetzt ist
+static inline int bitmapTest(const uint8_t *bitmap, int bit) {
+    return (bitmap[bit / 8] >> (bit % 8)) & 1;
+}
+
+// Vergleich von Sequenznummern mit Überlauf (Serial Number Arithmetic, RFC 1982):
+// a liegt vor b, wenn der vorzeichenbehaftete Abstand negativ ist
+static inline int seqLess(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+// Funktion zur Prüfung, ob seq_num im halboffenen Intervall [start, end) liegt
+static inline int seqInRange(uint32_t seq_num, uint32_t start, uint32_t end) {
+    return seq_num - start < end - start;
+}
+
+// Funktion zum Aufsummieren von 16-Bit-Wörtern für die Internet-Prüfsumme (RFC 1071)
+static inline uint64_t checksumAdd(uint64_t sum, const void *data, size_t len) {
+    const uint8_t *bytes = data;
+    while (len > 1) {
+        sum += (uint16_t)((bytes[0] << 8) | bytes[1]);
+        bytes += 2;
+        len -= 2;
+    }
+    if (len > 0) {
+        sum += (uint16_t)(bytes[0] << 8);
+    }
+    return sum;
+}
+
+// Funktion zum Abschließen der Internet-Prüfsumme (Einerkomplement)
+static inline uint16_t checksumFinish(uint64_t sum) {
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+// Funktion zum Befüllen eines Paketkopfs inklusive Prüfsumme über Kopf und Nutzdaten
+static inline void fillHeader(struct packet_header *header, uint8_t type, uint8_t flags, uint32_t session_id,
+                              uint32_t seq_num, const void *payload, uint16_t length) {
+    header->version = PROTOCOL_VERSION;
+    header->type = type;
+    header->flags = flags;
+    header->reserved = 0;
+    header->seq_num = htonl(seq_num);
+    header->session_id = htonl(session_id);
+    header->length = htons(length);
+    header->checksum = 0;
+
+    // Kopf hat eine gerade Länge, daher kann die Summe über die Nutzdaten fortgesetzt werden
+    uint64_t sum = checksumAdd(0, header, HEADER_SIZE);
+    sum = checksumAdd(sum, payload, length);
+    header->checksum = htons(checksumFinish(sum));
+}
+
+// Funktion zum Erstellen eines vollständigen Pakets im Puffer, gibt die Paketlänge zurück
+static inline int buildPacket(char *buffer, int buffer_size, uint8_t type, uint8_t flags, uint32_t session_id,
+                              uint32_t seq_num, const void *payload, int length) {
+    if (length < 0 || length > MAX_PAYLOAD || HEADER_SIZE + length > buffer_size) {
+        return -1;
+    }
+
+    struct packet_header header;
+    if (length > 0) {
+        memcpy(buffer + HEADER_SIZE, payload, length);
+    }
+    fillHeader(&header, type, flags, session_id, seq_num, buffer + HEADER_SIZE, (uint16_t)length);
+    memcpy(buffer, &header, HEADER_SIZE);
+    return HEADER_SIZE + length;
+}
+
+// Funktion zum Prüfen und Zerlegen eines empfangenen Pakets.
+// Der Kopf wird in Host-Byte-Reihenfolge zurückgegeben; 0 bei Erfolg, -1 bei fehlerhaftem Paket.
+static inline int parsePacket(const char *buffer, int len, struct packet_header *header, const char **payload) {
+    if (len < HEADER_SIZE) {
+        return -1;
+    }
+
+    memcpy(header, buffer, HEADER_SIZE);
+    if (header->version != PROTOCOL_VERSION) {
+        return -1;
+    }
+
+    int length = ntohs(header->length);
+    if (HEADER_SIZE + length != len) {
+        return -1;
+    }
+
+    // Prüfsumme über das gesamte Paket inklusive Prüfsummenfeld muss 0 ergeben
+    if (checksumFinish(checksumAdd(0, buffer, len)) != 0) {
+        return -1;
+    }
+
+    header->seq_num = ntohl(header->seq_num);
+    header->session_id = ntohl(header->session_id);
+    header->length = (uint16_t)length;
+    header->checksum = ntohs(header->checksum);
+    *payload = buffer + HEADER_SIZE;
+    return 0;
+}
+
+#endif
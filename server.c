@@ -1,4 +1,5 @@
 /* server.c */
+#define _GNU_SOURCE  // Für recvmmsg() und sendmmsg()
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,87 +8,1364 @@
 #include <unistd.h>
 #include <time.h>
 #include <stdbool.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sched.h>
+#include <netinet/udp.h>
+#include "protocol.h"
+#include "fec.h"
+#include "uring.h"
 
-#define BUF_SIZE 1024  // Maximale Größe eines empfangenen Pakets
-#define MAX_SEQ_NUM 1000  // Maximale erwartete Sequenznummer
+#define BUF_SIZE MAX_PACKET_SIZE  // Maximale Größe eines empfangenen Pakets
+#define OUTPUT_BUFFER_SIZE (1 << 20)  // Größe des Ausgabepuffers (1 MiB)
+#define FLUSH_INTERVAL 200000  // Spätestens nach dieser Zeit in Mikrosekunden wird der Ausgabepuffer geschrieben
+#define RECV_BATCH 64  // Maximale Anzahl an Datagrammen pro recvmmsg()-Aufruf
+#define SEND_BATCH 64  // Maximale Anzahl an Kontrollpaketen pro sendmmsg()-Aufruf
+#define MAX_EVENTS 4  // Maximale Anzahl an Ereignissen pro epoll_wait()-Aufruf
+#define REORDER_CAPACITY 1024  // Anzahl der Pakete, die vor expected_seq gepuffert werden können (Zweierpotenz)
+#define SESSION_BUCKETS 256  // Anzahl der Buckets der Sitzungstabelle (Zweierpotenz)
+#define MAX_WORKERS 64  // Maximale Anzahl an Empfangs-Threads (-t)
+#define NACK_BACKOFF_MAX 2000  // Obergrenze der zufälligen Wartezeit vor einem NACK in Mikrosekunden (2 ms)
+#define NACK_RETRY 50000  // Wartezeit auf die Wiederholung, bevor erneut ein NACK gesendet wird (50 ms)
+#define ACK_DELAY 2000  // Höchstens so lange wird ein ACK in Mikrosekunden verzögert (2 ms)
+#define ACK_EVERY 8  // Spätestens nach so vielen Datenpaketen wird sofort bestätigt
+#define CONTROL_PACKET_SIZE (HEADER_SIZE + SACK_BITMAP_BYTES)  // ACK mit voller SACK-Bitmaske ist das größte Kontrollpaket
+#define FEC_REPAIR_DELAY 10000  // Im FEC-Modus zusätzliche Wartezeit vor einem NACK, damit die Parität reparieren kann (10 ms)
+#define GRO_BUFFER_SIZE 65535  // Größe eines Empfangspuffers mit UDP GRO (zusammengefasste Datagramme)
+#define URING_ENTRIES 256  // Größe der Submission-Queue des io_uring-Backends (-u)
+#define URING_BUFFERS 128  // Anzahl der Empfangspuffer, die dem Kernel für Multishot-Empfang bereitstehen (Zweierpotenz)
+#define CACHE_LINE 64  // Ausrichtung der Paketpuffer, damit sich zwei Puffer keine Cache-Zeile teilen
+#define POOL_GROW 64  // Anzahl der Paketpuffer, um die der Pool bei Bedarf wächst
+#define WRITE_QUEUE_SIZE 64  // Einträge pro Warteschlange zum Schreib-Thread (Zweierpotenz)
+#define DISPATCH_QUEUE_SIZE 256  // Datagramme pro Warteschlange vom Verteiler zu einem Worker (Zweierpotenz)
+
+// Paketpuffer aus dem Pool des Threads. Empfangen wird direkt in einen solchen Puffer; wird ein Paket
+// im Umordnungspuffer zurückgehalten, hält der Eintrag eine Referenz, statt die Nutzdaten zu kopieren.
+// Ein per GRO zusammengefasstes Datagramm kann so von mehreren Einträgen gleichzeitig referenziert werden.
+struct packet_buffer {
+    int refcount;                         // Anzahl der Referenzen, bei 0 zurück in den Pool
+    bool handed_off;                      // Vom Verteiler an einen Worker übergeben, geht bei 0 Referenzen an ihn zurück
+    struct packet_buffer *next_free;      // Nächster freier Puffer im Pool
+    char data[] __attribute__((aligned(CACHE_LINE)));  // pool_buffer_size Bytes
+};
+
+// Eintrag im Umordnungspuffer für Pakete, die vor ihren Vorgängern eingetroffen sind.
+// Für ein fehlendes Paket steht hier stattdessen der Zeitpunkt seines nächsten NACKs.
+struct reorder_entry {
+    bool occupied;        // Gibt an, ob der Eintrag ein Paket enthält
+    uint32_t seq_num;     // Sequenznummer des gepufferten bzw. fehlenden Pakets
+    int length;           // Länge der Nutzdaten
+    const char *data;     // Nutzdaten innerhalb von packet
+    struct packet_buffer *packet;  // Referenzierter Paketpuffer
+    long long nack_due;   // Fehlendes Paket: Zeitpunkt des nächsten NACKs in Mikrosekunden, 0 wenn keins geplant
+};
+
+// Zeitpunkte, zu denen die Ausgabedatei mit fsync auf den Datenträger geschrieben wird
+enum fsync_policy {
+    FSYNC_NONE,           // Nie, das Betriebssystem entscheidet
+    FSYNC_CLOSE,          // Beim Schließen der Datei (CLOSE)
+    FSYNC_FLUSH           // Nach jedem Schreiben des Ausgabepuffers
+};
+
+// Gepufferte Ausgabe: die Datei bleibt pro Sitzung geöffnet, Datensätze werden im
+// Speicher gesammelt und bei vollem Puffer, nach FLUSH_INTERVAL oder bei CLOSE geschrieben
+struct output_writer {
+    char *filename;               // Name der Ausgabedatei
+    int fd;                       // Dateideskriptor, -1 wenn geschlossen
+    char *buffer;                 // Ausgabepuffer
+    size_t used;                  // Belegte Bytes im Ausgabepuffer
+    long long last_flush;         // Zeitpunkt des letzten Schreibens in Mikrosekunden
+    time_t cached_second;         // Sekunde, für die time_str formatiert wurde
+    char time_str[64];            // Formatierter Zeitstempel inklusive " - Seq "
+    int time_len;                 // Länge von time_str
+    struct write_chain *chain;    // Asynchrone Schreibaufträge der geöffneten Datei (io_uring), NULL wenn keine
+};
+
+// Empfangszustand eines FEC-Blocks aus fec_data Datenpaketen und bis zu fec_parity Paritätspaketen
+struct fec_block {
+    uint32_t start_seq;                   // Erste Sequenznummer des Blocks
+    bool active;                          // Eintrag ist für start_seq initialisiert
+    uint64_t received;                    // Bit i: Datenpaket start_seq + i ist eingerechnet
+    int count;                            // Datenpakete im Block laut Paritätspaket, 0 solange keins empfangen wurde
+    uint16_t parity_received;             // Bit j: Paritätspaket j ist eingerechnet
+    uint16_t length_xor[FEC_MAX_PARITY];  // XOR der Nutzdatenlängen pro Paritätsklasse
+    uint8_t *xor_data;                    // fec_parity Puffer zu je fec_max_payload Bytes, XOR pro Paritätsklasse
+};
+
+// Zustand einer Übertragung, identifiziert über Absenderadresse, Port und Sitzungskennung
+struct session {
+    struct sockaddr_in6 addr;             // Adresse des Senders
+    socklen_t addr_len;                   // Länge der Adresse
+    uint32_t session_id;                  // Vom Sender im HELLO gewählte Kennung
+    uint32_t expected_seq;                // Nächste erwartete Sequenznummer
+    uint32_t highest_seq;                 // Eins nach der höchsten empfangenen Sequenznummer
+    long long nack_deadline;              // Frühester geplanter NACK-Zeitpunkt, -1 wenn keiner
+    int unacked;                          // Seit der letzten Bestätigung empfangene Datenpakete
+    long long ack_due;                    // Zeitpunkt für das verzögerte ACK, -1 wenn keins aussteht
+    bool binary_mode;                     // Nutzdaten unverändert statt als Protokollzeilen schreiben
+    int fec_data;                         // n: Datenpakete pro FEC-Block, 0 ohne Vorwärtsfehlerkorrektur
+    int fec_parity;                       // k: Paritätspakete pro FEC-Block
+    int fec_max_payload;                  // Größte Nutzdatenlänge eines Datenpakets laut HELLO
+    uint32_t fec_base;                    // Initiale Sequenznummer, ab der die Blöcke gezählt werden
+    int fec_block_count;                  // Anzahl der Einträge in fec_blocks
+    struct fec_block *fec_blocks;         // Indiziert über Blocknummer % fec_block_count
+    uint8_t *fec_buffers;                 // Gemeinsamer Speicher für die XOR-Puffer aller Blöcke
+    struct reorder_entry *reorder_buffer; // REORDER_CAPACITY Einträge, indiziert über seq_num % REORDER_CAPACITY
+    struct output_writer writer;          // Gepufferte Ausgabe dieser Sitzung
+    struct session *next;                 // Nächste Sitzung im selben Bucket
+};
+
+// Auftrag an den Schreib-Thread (Worker-Modus) bzw. an io_uring
+enum write_op {
+    WRITE_DATA,           // Puffer schreiben und freigeben
+    WRITE_CLOSE           // Datei je nach fsync_policy synchronisieren und schließen
+};
+
+struct write_request {
+    int op;               // enum write_op
+    int fd;               // Dateideskriptor der Sitzung
+    char *data;           // Zu schreibende Daten, gehören ab der Übergabe dem Schreib-Thread
+    size_t len;           // Länge der Daten
+};
+
+// Asynchroner Schreibauftrag im io_uring-Backend. Ein WRITE_DATA-Auftrag schreibt den Puffer
+// (bei kurzem Schreiben in mehreren Schritten) und synchronisiert je nach fsync_policy, ein
+// WRITE_CLOSE-Auftrag synchronisiert je nach fsync_policy und schließt die Datei.
+struct write_job {
+    int op;                       // enum write_op
+    int phase;                    // 0 = Schreiben bzw. fsync vor dem Schließen, 1 = fsync nach dem Schreiben bzw. close
+    char *data;                   // Zu schreibende Daten, gehören dem Auftrag
+    size_t len;                   // Länge der Daten
+    size_t written;               // Bereits geschriebene Bytes
+    struct write_job *next;       // Nächster Auftrag derselben Datei
+};
+
+// Aufträge einer Datei laufen nacheinander, damit die Reihenfolge im O_APPEND-Modus erhalten bleibt.
+// Die Kette lebt bis zum Abschluss ihres WRITE_CLOSE-Auftrags, also auch über das Ende der Sitzung hinaus.
+struct write_chain {
+    int fd;                       // Dateideskriptor
+    struct write_job *head;       // Laufender Auftrag
+    struct write_job *tail;       // Zuletzt angehängter Auftrag
+};
+
+// Lock-freie Warteschlange mit genau einem Erzeuger (Worker) und einem Verbraucher (Schreib-Thread).
+// head und tail liegen in getrennten Cache-Zeilen, damit sich die beiden Threads nicht gegenseitig ausbremsen.
+struct write_queue {
+    struct write_request entries[WRITE_QUEUE_SIZE];
+    _Alignas(64) atomic_size_t head;      // Nächster zu lesender Eintrag (nur Schreib-Thread)
+    _Alignas(64) atomic_size_t tail;      // Nächster freier Eintrag (nur Worker)
+};
+
+// Vom Verteiler an einen Worker übergebenes Datagramm. Der Paketpuffer gehört ab der Übergabe dem Worker.
+struct dispatch_entry {
+    struct packet_buffer *packet;         // Paketpuffer mit einer Referenz für den Worker
+    char *data;                           // Datagramm innerhalb von packet
+    int len;                              // Länge des Datagramms
+    int segment;                          // Segmentgröße aus UDP_GRO, 0 für ein einzelnes Paket
+    struct sockaddr_in6 addr;             // Absender
+    socklen_t addr_len;                   // Länge der Absenderadresse
+};
+
+// Lock-freie Warteschlange vom Verteiler (Hauptthread) zu einem Worker, ebenfalls mit genau einem
+// Erzeuger und einem Verbraucher. Über event_fd weckt der Verteiler den Worker nach jedem Empfangsstapel.
+struct dispatch_queue {
+    struct dispatch_entry entries[DISPATCH_QUEUE_SIZE];
+    int event_fd;                         // eventfd des Workers
+    _Alignas(64) atomic_size_t head;      // Nächster zu lesender Eintrag (nur Worker)
+    _Alignas(64) atomic_size_t tail;      // Nächster freier Eintrag (nur Verteiler)
+};
+
+// Sitzungen, Empfangs- und Sendepuffer gehören jeweils einem Thread
+__thread struct session *sessions[SESSION_BUCKETS];  // Hash-Tabelle der aktiven Sitzungen
+__thread int session_count = 0;                      // Anzahl der aktiven Sitzungen
+
+const char *multicast_group;                // IPv6-Multicast-Adresse aus der Kommandozeile
+struct sockaddr_in6 group_addr;             // Multicast-Gruppe als Ziel für NACKs an die anderen Empfänger
+int listen_port;                            // Portnummer aus der Kommandozeile
+const char *output_file;                    // Name der Ausgabedatei aus der Kommandozeile
+bool separate_files = false;                // Jede Sitzung in eine eigene Datei <output_file>.<session_id> schreiben
+int fsync_policy = FSYNC_NONE;              // enum fsync_policy
+bool raw_output = false;                    // Auch Textzeilen unverändert statt als Protokollzeilen schreiben (-r)
+int stream_fd = -1;                         // Ausgabe auf stdout ("-"): ursprünglicher stdout, sonst -1
+bool stream_finished = false;               // Übertragung auf stdout ist beendet, der Server beendet sich
+
+bool use_uring = false;                     // io_uring statt epoll und synchroner Schreibaufrufe verwenden (-u)
+__thread struct uring *uring;               // Ring des Threads, solange das io_uring-Backend läuft
+__thread int uring_chains = 0;              // Dateien mit noch nicht abgeschlossenen Schreibaufträgen
+
+int worker_count = 0;                       // Anzahl der Worker-Threads, 0 = alles im Hauptthread
+__thread int worker_index = 0;              // Nummer des aufrufenden Workers
+__thread struct write_queue *write_queue;   // Warteschlange des Workers zum Schreib-Thread, NULL im Hauptthread
+struct write_queue *write_queues;           // Eine Warteschlange pro Worker
+int writer_event_fd = -1;                   // eventfd, über das Worker den Schreib-Thread wecken
+atomic_bool writer_stop = false;            // Schreib-Thread nach dem Leeren der Warteschlangen beenden
+
+// Worker-Modus: nur der Hauptthread empfängt und verteilt die Datagramme nach Sitzung an die Worker.
+// Jedes Datagramm wird so einmal statt von jedem Worker-Socket der Gruppe empfangen.
+__thread bool dispatching = false;          // Der Thread ist der Verteiler (Hauptthread mit -t)
+__thread struct dispatch_queue *dispatch_queue;  // Warteschlange des Workers vom Verteiler, NULL im Hauptthread
+struct dispatch_queue *dispatch_queues;     // Eine Warteschlange pro Worker
+uint64_t dispatch_pending = 0;              // Bit w: Worker w hat seit dem letzten Wecken neue Datagramme (nur Verteiler)
+atomic_bool dispatch_stop = false;          // Worker nach dem Ende des Verteilers beenden
+_Atomic(struct packet_buffer *) returned_packets = NULL;  // Von Workern freigegebene Puffer des Verteilers
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// Pool gleich großer Paketpuffer des Threads, vorab angelegt und bei Bedarf in Blöcken vergrößert.
+// Der Pool ist thread-lokal, daher kommen die Referenzzähler ohne atomare Operationen aus. Ein an einen
+// Worker übergebener Puffer wird danach nur noch von diesem angefasst und kommt über returned_packets zurück.
+__thread size_t pool_buffer_size;           // Nutzbare Größe eines Paketpuffers
+__thread size_t pool_stride;                // Abstand zweier Paketpuffer im Speicher
+__thread struct packet_buffer *pool_free;   // Freie Paketpuffer
+__thread void **pool_blocks;                // Angelegte Speicherblöcke (zum Freigeben)
+__thread int pool_block_count;
+__thread struct packet_buffer *current_packet;  // Puffer des gerade verarbeiteten Datagramms, NULL wenn keiner
+
+// Empfangspuffer aus dem Pool, die mit einem recvmmsg()-Aufruf befüllt werden. Mit UDP GRO fasst
+// der Kernel gleich große Datagramme eines Senders zusammen, daher sind die Puffer dann größer.
+bool gro_enabled = false;                   // UDP_GRO ist auf dem Empfangssocket aktiv
+__thread size_t recv_buffer_size;           // Größe eines Empfangspuffers
+__thread struct packet_buffer *recv_packets[RECV_BATCH];
+__thread char recv_controls[RECV_BATCH][CMSG_SPACE(sizeof(int))];  // Segmentgröße aus UDP_GRO
+__thread struct sockaddr_in6 recv_addrs[RECV_BATCH];
+__thread struct iovec recv_iovs[RECV_BATCH];
+__thread struct mmsghdr recv_msgs[RECV_BATCH];
+
+// Gesammelte Kontrollpakete (ACK, NACK, ...), die gemeinsam per sendmmsg() verschickt werden
+__thread char send_packets[SEND_BATCH][CONTROL_PACKET_SIZE];
+__thread struct sockaddr_in6 send_addrs[SEND_BATCH];
+__thread struct iovec send_iovs[SEND_BATCH];
+__thread struct mmsghdr send_msgs[SEND_BATCH];
+__thread int send_count = 0;
 
 // Funktion zur Ausgabe der Nutzungsanleitung
 void usage() {
-    printf("Usage: server <multicast_addr> <port> <output_file>\n");
+    printf("Usage: server [-f none|close|flush] [-m] [-r] [-t workers] [-u] <multicast_addr> <port> <output_file|->\n");
+    printf("  -f policy  When to fsync the output file: never (default), on CLOSE or after every flush\n");
+    printf("  -m         Write every session to its own file <output_file>.<session_id>\n");
+    printf("  -r         Write the raw byte stream of text transfers too, without timestamps (e.g. to a FIFO)\n");
+    printf("  -          As output_file: write one raw transfer to stdout, log to stderr, then exit\n");
+    printf("  -t n       Process sessions on n worker threads; one socket receives and hands packets to them by session hash\n");
+    printf("  -u         Use io_uring for receiving and writing (falls back to epoll if unavailable)\n");
     exit(EXIT_FAILURE);
 }
 
-// Funktion zum Hinzufügen von Datum und Uhrzeit zur Datei
-void logMessageToFile(const char *filename, const char *message) {
-    FILE *file = fopen(filename, "a");  // Öffnet die Datei im Anhängemodus, erstellt sie falls nötig
-    if (!file) {
-        perror("fopen");
-        exit(EXIT_FAILURE);
+// Funktion zum Abfragen der monotonen Uhrzeit in Mikrosekunden
+long long nowMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+// Funktion zum Stellen eines timerfd auf einen absoluten Zeitpunkt (CLOCK_MONOTONIC, Mikrosekunden)
+void setTimerFd(int timer_fd, long long deadline) {
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = deadline / 1000000;
+    spec.it_value.tv_nsec = (deadline % 1000000) * 1000;
+    if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+        spec.it_value.tv_nsec = 1;  // 0 würde den Timer deaktivieren
+    }
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0) {
+        perror("timerfd_settime");
+    }
+}
+
+// Funktion zum Öffnen der Ausgabedatei (einmal pro Sitzung, im Anhängemodus).
+// Durch O_APPEND landen die Schreibvorgänge mehrerer Sitzungen in derselben Datei nie übereinander.
+void openOutput(struct output_writer *writer) {
+    if (writer->fd >= 0) {
+        return;
+    }
+
+    // Bei einer FIFO blockiert open(), bis ein Leser sie geöffnet hat
+    writer->fd = stream_fd >= 0 ? stream_fd : open(writer->filename, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (writer->fd < 0) {
+        perror("open");
+        exit(EXIT_FAILURE);
+    }
+    writer->last_flush = nowMicros();
+}
+
+// Funktion zum vollständigen Schreiben eines Puffers in eine Datei
+void writeBuffer(int fd, const char *data, size_t len) {
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = write(fd, data + written, len - written);
+        if (n < 0) {
+            perror("write");
+            exit(EXIT_FAILURE);
+        }
+        written += (size_t)n;
+    }
+}
+
+// Funktion zum Synchronisieren der Ausgabedatei; Pipes und FIFOs unterstützen kein fsync (EINVAL)
+void syncOutput(int fd) {
+    if (fsync(fd) < 0 && errno != EINVAL) {
+        perror("fsync");
+    }
+}
+
+// Funktion zum Übergeben eines Auftrags an den Schreib-Thread, wartet bei voller Warteschlange
+void submitWrite(int op, int fd, char *data, size_t len) {
+    size_t tail = atomic_load_explicit(&write_queue->tail, memory_order_relaxed);
+    while (tail - atomic_load_explicit(&write_queue->head, memory_order_acquire) == WRITE_QUEUE_SIZE) {
+        sched_yield();
+    }
+
+    struct write_request *request = &write_queue->entries[tail & (WRITE_QUEUE_SIZE - 1)];
+    request->op = op;
+    request->fd = fd;
+    request->data = data;
+    request->len = len;
+    atomic_store_explicit(&write_queue->tail, tail + 1, memory_order_release);
+
+    uint64_t signal = 1;
+    if (write(writer_event_fd, &signal, sizeof(signal)) < 0) {
+        perror("write (eventfd)");
+    }
+}
+
+// Funktion zum Übergeben des laufenden Auftrags einer Datei an io_uring
+void submitJob(struct write_chain *chain) {
+    struct write_job *job = chain->head;
+    struct io_uring_sqe *sqe = uringGetSqe(uring);
+    if (!sqe) {
+        perror("io_uring_enter");
+        exit(EXIT_FAILURE);
+    }
+
+    sqe->fd = chain->fd;
+    sqe->user_data = (uint64_t)(uintptr_t)chain;
+    if (job->op == WRITE_DATA && job->phase == 0) {
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->addr = (uint64_t)(uintptr_t)(job->data + job->written);
+        sqe->len = (uint32_t)(job->len - job->written);
+        sqe->off = (uint64_t)-1;  // Aktuelle Dateiposition, bei O_APPEND das Dateiende
+    } else if (job->op == WRITE_CLOSE && job->phase == 1) {
+        sqe->opcode = IORING_OP_CLOSE;
+    } else {
+        sqe->opcode = IORING_OP_FSYNC;
+    }
+}
+
+// Funktion zum Anhängen eines Auftrags an die Kette der Ausgabedatei; läuft keiner, wird er sofort übergeben
+void queueJob(struct output_writer *writer, int op, char *data, size_t len) {
+    struct write_job *job = calloc(1, sizeof(*job));
+    if (!job) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    job->op = op;
+    job->data = data;
+    job->len = len;
+    if (op == WRITE_CLOSE && fsync_policy == FSYNC_NONE) {
+        job->phase = 1;  // Ohne fsync direkt schließen
+    }
+
+    if (!writer->chain) {
+        writer->chain = calloc(1, sizeof(struct write_chain));
+        if (!writer->chain) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        writer->chain->fd = writer->fd;
+        uring_chains++;
+    }
+
+    struct write_chain *chain = writer->chain;
+    if (chain->tail) {
+        chain->tail->next = job;
+        chain->tail = job;
+    } else {
+        chain->head = chain->tail = job;
+        submitJob(chain);
+    }
+}
+
+// Funktion zur Verarbeitung des Abschlusses des laufenden Auftrags einer Datei
+void completeJob(struct write_chain *chain, int result) {
+    struct write_job *job = chain->head;
+    if (result < 0) {
+        // Fehlgeschlagenes Schreiben ist wie im synchronen Pfad fatal, fsync/close nur eine Warnung
+        errno = -result;
+        if (job->op == WRITE_DATA && job->phase == 0) {
+            perror("write");
+            exit(EXIT_FAILURE);
+        }
+        if (job->op == WRITE_CLOSE && job->phase == 1) {
+            perror("close");
+        } else if (result != -EINVAL) {
+            perror("fsync");
+        }
+    }
+
+    if (job->op == WRITE_DATA && job->phase == 0) {
+        job->written += (size_t)result;
+        if (job->written < job->len) {
+            submitJob(chain);  // Kurzes Schreiben: Rest übergeben
+            return;
+        }
+        if (fsync_policy == FSYNC_FLUSH) {
+            job->phase = 1;
+            submitJob(chain);
+            return;
+        }
+    } else if (job->op == WRITE_CLOSE && job->phase == 0) {
+        job->phase = 1;
+        submitJob(chain);
+        return;
+    }
+
+    // Auftrag erledigt: nächsten derselben Datei starten oder die Kette nach dem Schließen auflösen
+    bool closed = job->op == WRITE_CLOSE;
+    chain->head = job->next;
+    if (!chain->head) {
+        chain->tail = NULL;
+    }
+    free(job->data);
+    free(job);
+    if (chain->head) {
+        submitJob(chain);
+    } else if (closed) {
+        free(chain);
+        uring_chains--;
+    }
+}
+
+// Funktion zum Schreiben des gesammelten Puffers in die Ausgabedatei.
+// Im Worker-Modus wird der volle Puffer an den Schreib-Thread übergeben und durch einen neuen ersetzt,
+// im io_uring-Backend als asynchroner Auftrag an den Kernel.
+void flushOutput(struct output_writer *writer) {
+    if (write_queue || uring) {
+        if (writer->used > 0) {
+            if (write_queue) {
+                submitWrite(WRITE_DATA, writer->fd, writer->buffer, writer->used);
+            } else {
+                queueJob(writer, WRITE_DATA, writer->buffer, writer->used);
+            }
+            writer->buffer = malloc(OUTPUT_BUFFER_SIZE);
+            if (!writer->buffer) {
+                perror("malloc");
+                exit(EXIT_FAILURE);
+            }
+        }
+        writer->used = 0;
+        writer->last_flush = nowMicros();
+        return;
+    }
+
+    writeBuffer(writer->fd, writer->buffer, writer->used);
+    writer->used = 0;
+    writer->last_flush = nowMicros();
+
+    if (fsync_policy == FSYNC_FLUSH && writer->fd >= 0) {
+        syncOutput(writer->fd);
+    }
+}
+
+// Funktion zum Schreiben des Puffers, wenn die Zeitschwelle seit dem letzten Schreiben überschritten ist
+void flushOutputIfDue(struct output_writer *writer) {
+    if (writer->used > 0 && nowMicros() - writer->last_flush >= FLUSH_INTERVAL) {
+        flushOutput(writer);
+    }
+}
+
+// Funktion zum Schließen der Ausgabedatei am Ende einer Sitzung
+void closeOutput(struct output_writer *writer) {
+    if (writer->fd < 0) {
+        return;
+    }
+
+    flushOutput(writer);
+    if (write_queue) {
+        // Der Schreib-Thread schließt die Datei, nachdem alle vorherigen Puffer geschrieben sind
+        submitWrite(WRITE_CLOSE, writer->fd, NULL, 0);
+    } else if (uring) {
+        // Die Kette schließt die Datei nach ihren Schreibaufträgen und gibt sich dann selbst frei
+        queueJob(writer, WRITE_CLOSE, NULL, 0);
+        writer->chain = NULL;
+    } else {
+        if (fsync_policy != FSYNC_NONE) {
+            syncOutput(writer->fd);
+        }
+        close(writer->fd);
+    }
+    writer->fd = -1;
+}
+
+// Funktion zum Anhängen von Daten an den Ausgabepuffer, geschrieben wird erst bei vollem Puffer
+void appendOutput(struct output_writer *writer, const char *data, size_t len) {
+    openOutput(writer);
+    if (writer->used + len > OUTPUT_BUFFER_SIZE) {
+        flushOutput(writer);
+    }
+    memcpy(writer->buffer + writer->used, data, len);
+    writer->used += len;
+}
+
+// Funktion zum Anhängen einer Protokollzeile mit Datum und Uhrzeit an den Ausgabepuffer.
+// Der Zeitstempel wird nur einmal pro Sekunde neu formatiert.
+void appendLogRecord(struct output_writer *writer, uint32_t seq_num, const char *payload, int length) {
+    time_t now = time(NULL);
+    if (now != writer->cached_second) {
+        struct tm t;
+        localtime_r(&now, &t);
+        writer->time_len = (int)strftime(writer->time_str, sizeof(writer->time_str), "%Y-%m-%d %H:%M:%S - Seq ", &t);
+        writer->cached_second = now;
+    }
+
+    char seq_str[16];
+    int seq_len = snprintf(seq_str, sizeof(seq_str), "%u: ", seq_num);
+
+    // Datensatz: "<Zeitstempel> - Seq <n>: <Nutzdaten>\n"
+    openOutput(writer);
+    if (writer->used + writer->time_len + seq_len + length + 1 > OUTPUT_BUFFER_SIZE) {
+        flushOutput(writer);
+    }
+    char *record = writer->buffer + writer->used;
+    memcpy(record, writer->time_str, writer->time_len);
+    record += writer->time_len;
+    memcpy(record, seq_str, seq_len);
+    record += seq_len;
+    memcpy(record, payload, length);
+    record += length;
+    *record++ = '\n';
+    writer->used = record - writer->buffer;
+}
+
+// Funktion zum Berechnen des Buckets einer Sitzung (FNV-1a über Adresse, Port und Sitzungskennung)
+unsigned int sessionHash(const struct sockaddr_in6 *addr, uint32_t session_id) {
+    uint32_t hash = 2166136261u;
+    const uint8_t *bytes = addr->sin6_addr.s6_addr;
+    for (int i = 0; i < 16; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    hash = (hash ^ (addr->sin6_port & 0xFF)) * 16777619u;
+    hash = (hash ^ (addr->sin6_port >> 8)) * 16777619u;
+    for (int i = 0; i < 4; i++) {
+        hash = (hash ^ ((session_id >> (8 * i)) & 0xFF)) * 16777619u;
+    }
+    return hash & (SESSION_BUCKETS - 1);
+}
+
+// Funktion zum Suchen einer Sitzung, gibt NULL zurück, wenn keine existiert
+struct session *findSession(const struct sockaddr_in6 *addr, uint32_t session_id) {
+    struct session *session = sessions[sessionHash(addr, session_id)];
+    while (session) {
+        if (session->session_id == session_id && session->addr.sin6_port == addr->sin6_port &&
+            memcmp(&session->addr.sin6_addr, &addr->sin6_addr, sizeof(addr->sin6_addr)) == 0) {
+            return session;
+        }
+        session = session->next;
+    }
+    return NULL;
+}
+
+// Funktion zum Vergrößern des Paketpuffer-Pools um count Puffer
+void growPool(int count) {
+    void *block = aligned_alloc(CACHE_LINE, pool_stride * count);
+    void **blocks = realloc(pool_blocks, (pool_block_count + 1) * sizeof(void *));
+    if (!block || !blocks) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    pool_blocks = blocks;
+    pool_blocks[pool_block_count++] = block;
+    for (int i = 0; i < count; i++) {
+        struct packet_buffer *packet = (struct packet_buffer *)((char *)block + i * pool_stride);
+        packet->refcount = 0;
+        packet->next_free = pool_free;
+        pool_free = packet;
+    }
+}
+
+// Funktion zum Zurückgeben eines Puffers des Verteilers aus einem Worker. Lock-freier Stapel mit
+// mehreren Erzeugern; der Verteiler entnimmt immer den ganzen Stapel, daher gibt es kein ABA-Problem.
+void returnPacket(struct packet_buffer *packet) {
+    struct packet_buffer *head = atomic_load_explicit(&returned_packets, memory_order_relaxed);
+    do {
+        packet->next_free = head;
+    } while (!atomic_compare_exchange_weak_explicit(&returned_packets, &head, packet, memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+// Funktion zum Entnehmen eines Paketpuffers aus dem Pool, mit einer Referenz
+struct packet_buffer *acquirePacket() {
+    if (!pool_free && dispatching) {
+        pool_free = atomic_exchange_explicit(&returned_packets, NULL, memory_order_acquire);
+    }
+    if (!pool_free) {
+        growPool(POOL_GROW);
+    }
+    struct packet_buffer *packet = pool_free;
+    pool_free = packet->next_free;
+    packet->refcount = 1;
+    packet->handed_off = false;
+    return packet;
+}
+
+// Funktion zum Freigeben einer Referenz, der letzte Halter gibt den Puffer an den Pool zurück
+void releasePacket(struct packet_buffer *packet) {
+    if (packet && --packet->refcount == 0) {
+        if (packet->handed_off) {
+            returnPacket(packet);
+            return;
+        }
+        packet->next_free = pool_free;
+        pool_free = packet;
+    }
+}
+
+// Funktion zum Ersetzen eines Empfangspuffers, wenn nach der Verarbeitung noch Einträge des
+// Umordnungspuffers darauf verweisen oder er an einen Worker übergeben wurde. Gibt true zurück, wenn ersetzt wurde.
+bool replaceRetained(struct packet_buffer **slot) {
+    if ((*slot)->handed_off) {
+        *slot = acquirePacket();  // Die Referenz gehört jetzt dem Worker
+        return true;
+    }
+    if ((*slot)->refcount == 1) {
+        return false;
+    }
+    releasePacket(*slot);
+    *slot = acquirePacket();
+    return true;
+}
+
+// Funktion zum Anlegen einer neuen Sitzung beim ersten HELLO eines Senders
+struct session *createSession(const struct sockaddr_in6 *addr, socklen_t addr_len, uint32_t session_id) {
+    struct session *session = calloc(1, sizeof(*session));
+    if (!session) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(&session->addr, addr, addr_len);
+    session->addr_len = addr_len;
+    session->session_id = session_id;
+
+    session->reorder_buffer = calloc(REORDER_CAPACITY, sizeof(struct reorder_entry));
+    session->writer.buffer = malloc(OUTPUT_BUFFER_SIZE);
+    if (!session->reorder_buffer || !session->writer.buffer) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    // Eigene Datei pro Sitzung (-m) oder gemeinsame Datei für alle Sitzungen
+    if (separate_files) {
+        size_t name_len = strlen(output_file) + 10;
+        session->writer.filename = malloc(name_len);
+        if (session->writer.filename) {
+            snprintf(session->writer.filename, name_len, "%s.%08x", output_file, session_id);
+        }
+    } else {
+        session->writer.filename = strdup(output_file);
+    }
+    if (!session->writer.filename) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    session->writer.fd = -1;
+    session->writer.cached_second = -1;
+
+    unsigned int bucket = sessionHash(addr, session_id);
+    session->next = sessions[bucket];
+    sessions[bucket] = session;
+    session_count++;
+    return session;
+}
+
+// Funktion zum Leeren des Umordnungspuffers einer Sitzung (bei HELLO und CLOSE)
+void clearReorderBuffer(struct session *session) {
+    for (int i = 0; i < REORDER_CAPACITY; i++) {
+        releasePacket(session->reorder_buffer[i].packet);
+        session->reorder_buffer[i].packet = NULL;
+        session->reorder_buffer[i].data = NULL;
+        session->reorder_buffer[i].occupied = false;
+        session->reorder_buffer[i].nack_due = 0;
+    }
+    session->nack_deadline = -1;
+}
+
+// Funktion zum Freigeben des FEC-Zustands einer Sitzung
+void freeFec(struct session *session) {
+    free(session->fec_blocks);
+    free(session->fec_buffers);
+    session->fec_blocks = NULL;
+    session->fec_buffers = NULL;
+    session->fec_data = 0;
+}
+
+// Funktion zum Einrichten des FEC-Zustands aus den Parametern im HELLO.
+// Die Blocktabelle deckt den gesamten Umordnungspuffer ab, damit jeder annehmbare Block einen Eintrag hat.
+void setupFec(struct session *session, const struct fec_params *params) {
+    freeFec(session);
+    int data_count = params->data_count;
+    int parity_count = params->parity_count;
+    int max_payload = ntohs(params->max_payload);
+    if (data_count < 1 || data_count > FEC_MAX_DATA || parity_count < 1 || parity_count > FEC_MAX_PARITY ||
+        parity_count > data_count || max_payload < 1 || max_payload > FEC_MAX_DATA_PAYLOAD) {
+        printf("Invalid FEC parameters ignored.\n");
+        return;
+    }
+
+    session->fec_data = data_count;
+    session->fec_parity = parity_count;
+    session->fec_max_payload = max_payload;
+    session->fec_base = session->expected_seq;
+    session->fec_block_count = REORDER_CAPACITY / data_count + 2;
+    session->fec_blocks = calloc(session->fec_block_count, sizeof(struct fec_block));
+    session->fec_buffers = malloc((size_t)session->fec_block_count * parity_count * max_payload);
+    if (!session->fec_blocks || !session->fec_buffers) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < session->fec_block_count; i++) {
+        session->fec_blocks[i].xor_data = session->fec_buffers + (size_t)i * parity_count * max_payload;
+    }
+    printf("FEC enabled: %d parity packets per %d data packets.\n", parity_count, data_count);
+}
+
+// Funktion zum Beenden einer Sitzung: Ausgabe schreiben, aus der Tabelle entfernen und freigeben
+void removeSession(struct session *session) {
+    struct session **link = &sessions[sessionHash(&session->addr, session->session_id)];
+    while (*link != session) {
+        link = &(*link)->next;
+    }
+    *link = session->next;
+    session_count--;
+
+    clearReorderBuffer(session);
+    closeOutput(&session->writer);  // Restliche Datensätze schreiben und Datei schließen
+    free(session->reorder_buffer);
+    freeFec(session);
+    free(session->writer.buffer);
+    free(session->writer.filename);
+    free(session);
+}
+
+// Funktion zum Ermitteln des frühesten Zeitpunkts, zu dem eine Sitzung Ausgabe schreiben
+// oder ein ACK bzw. NACK senden muss, -1 wenn keiner ansteht
+long long nextSessionDeadline() {
+    long long deadline = -1;
+    for (int i = 0; i < SESSION_BUCKETS; i++) {
+        for (struct session *session = sessions[i]; session; session = session->next) {
+            long long due = session->writer.last_flush + FLUSH_INTERVAL;
+            if (session->writer.used > 0 && (deadline < 0 || due < deadline)) {
+                deadline = due;
+            }
+            if (session->nack_deadline >= 0 && (deadline < 0 || session->nack_deadline < deadline)) {
+                deadline = session->nack_deadline;
+            }
+            if (session->ack_due >= 0 && (deadline < 0 || session->ack_due < deadline)) {
+                deadline = session->ack_due;
+            }
+        }
+    }
+    return deadline;
+}
+
+// Funktion zum Anlegen des Paketpuffer-Pools und Verknüpfen der Empfangs- und Sendepuffer mit den
+// mmsghdr-Strukturen. Die Paketpuffer bieten zusätzlich Platz für den Kopf, die Adresse und die
+// Steuerdaten eines io_uring-Multishot-Empfangs, damit beide Backends denselben Pool nutzen.
+// Worker empfangen nicht selbst (receiving = false); ihr Pool wächst nur für aus der Parität
+// wiederhergestellte Pakete, die Puffer sind aber gleich groß wie die des Verteilers.
+void initBatches(bool receiving) {
+    recv_buffer_size = gro_enabled ? GRO_BUFFER_SIZE : BUF_SIZE;
+    pool_buffer_size = sizeof(struct io_uring_recvmsg_out) + sizeof(struct sockaddr_in6) +
+                       CMSG_SPACE(sizeof(int)) + recv_buffer_size;
+    pool_buffer_size = (pool_buffer_size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    pool_stride = sizeof(struct packet_buffer) + pool_buffer_size;
+    if (receiving) {
+        growPool(2 * RECV_BATCH);
+    }
+
+    for (int i = 0; receiving && i < RECV_BATCH; i++) {
+        recv_packets[i] = acquirePacket();
+        recv_iovs[i].iov_base = recv_packets[i]->data;
+        recv_iovs[i].iov_len = recv_buffer_size;
+        memset(&recv_msgs[i], 0, sizeof(recv_msgs[i]));
+        recv_msgs[i].msg_hdr.msg_iov = &recv_iovs[i];
+        recv_msgs[i].msg_hdr.msg_iovlen = 1;
+        recv_msgs[i].msg_hdr.msg_name = &recv_addrs[i];
+    }
+    for (int i = 0; i < SEND_BATCH; i++) {
+        send_iovs[i].iov_base = send_packets[i];
+        memset(&send_msgs[i], 0, sizeof(send_msgs[i]));
+        send_msgs[i].msg_hdr.msg_iov = &send_iovs[i];
+        send_msgs[i].msg_hdr.msg_iovlen = 1;
+        send_msgs[i].msg_hdr.msg_name = &send_addrs[i];
+    }
+}
+
+// Funktion zum Freigeben der Empfangspuffer und des Pools des aufrufenden Threads.
+// Alle Sitzungen müssen bereits geschlossen sein, da sie sonst noch Paketpuffer referenzieren.
+void freeBatches() {
+    for (int i = 0; i < RECV_BATCH; i++) {
+        releasePacket(recv_packets[i]);
+        recv_packets[i] = NULL;
+    }
+    for (int i = 0; i < pool_block_count; i++) {
+        free(pool_blocks[i]);
+    }
+    free(pool_blocks);
+    pool_blocks = NULL;
+    pool_block_count = 0;
+    pool_free = NULL;
+}
+
+// Funktion zum Senden aller gesammelten Kontrollpakete mit möglichst wenigen sendmmsg()-Aufrufen
+void flushControlPackets(int sock) {
+    int sent = 0;
+    while (sent < send_count) {
+        int n = sendmmsg(sock, send_msgs + sent, send_count - sent, 0);
+        if (n < 0) {
+            perror("sendmmsg");
+            break;
+        }
+        sent += n;
+    }
+    send_count = 0;
+}
+
+// Funktion zum Einreihen eines Kontrollpakets (HELLO ACK, CLOSE ACK, ACK, NACK) in den Sendestapel.
+// ACKs und NACKs tragen Nutzdaten (Bitmasken, kumulative Bestätigung).
+void queueControlPacket(int sock, struct sockaddr_in6 *dest_addr, socklen_t dest_addr_len, uint8_t type,
+                        uint32_t session_id, uint32_t seq_num, const void *payload, int length) {
+    if (send_count == SEND_BATCH) {
+        flushControlPackets(sock);
+    }
+
+    int i = send_count++;
+    send_iovs[i].iov_len = buildPacket(send_packets[i], sizeof(send_packets[i]), type, 0, session_id, seq_num,
+                                       payload, length);
+    memcpy(&send_addrs[i], dest_addr, dest_addr_len);
+    send_msgs[i].msg_hdr.msg_namelen = dest_addr_len;
+}
+
+// Funktion zum Ausliefern von Nutzdaten in Sequenzreihenfolge an die Ausgabedatei der Sitzung
+void deliverPayload(struct session *session, uint32_t seq_num, const char *payload, int length) {
+    if (session->binary_mode || raw_output) {
+        appendOutput(&session->writer, payload, length);
+    } else {
+        appendLogRecord(&session->writer, seq_num, payload, length);
+    }
+}
+
+// Funktion zum Puffern eines vorgezogenen Pakets, gibt false zurück, wenn es schon gepuffert ist.
+// Liegen die Nutzdaten im Empfangspuffer des aktuellen Datagramms, wird dieser nur referenziert;
+// aus der Parität wiederhergestellte Pakete werden in einen eigenen Paketpuffer kopiert.
+bool bufferPacket(struct session *session, uint32_t seq_num, const char *payload, int length) {
+    struct reorder_entry *entry = &session->reorder_buffer[seq_num % REORDER_CAPACITY];
+    if (entry->occupied) {
+        return false;
+    }
+
+    struct packet_buffer *packet = current_packet;
+    if (packet && payload >= packet->data && payload + length <= packet->data + pool_buffer_size) {
+        packet->refcount++;
+    } else {
+        packet = acquirePacket();
+        memcpy(packet->data, payload, length);
+        payload = packet->data;
+    }
+    entry->packet = packet;
+    entry->data = payload;
+    entry->seq_num = seq_num;
+    entry->length = length;
+    entry->occupied = true;
+    return true;
+}
+
+// Funktion zum Ausliefern aller gepufferten Pakete, die lückenlos an expected_seq anschließen
+void flushReorderBuffer(struct session *session) {
+    while (1) {
+        struct reorder_entry *entry = &session->reorder_buffer[session->expected_seq % REORDER_CAPACITY];
+        if (!entry->occupied || entry->seq_num != session->expected_seq) {
+            break;
+        }
+
+        deliverPayload(session, entry->seq_num, entry->data, entry->length);
+        releasePacket(entry->packet);
+        entry->packet = NULL;
+        entry->data = NULL;
+        entry->occupied = false;
+        session->expected_seq++;
+    }
+}
+
+// Funktion zur Verarbeitung von Kontrollnachrichten
+void handleControlMessage(const struct packet_header *header, const char *payload, int sock,
+                          struct sockaddr_in6 *src_addr, socklen_t src_addr_len) {
+    struct session *session = findSession(src_addr, header->session_id);
+
+    if (header->type == PKT_HELLO) {
+        char addr_str[INET6_ADDRSTRLEN]; // Buffer für die IPv6-Adresse
+        if (inet_ntop(AF_INET6, &src_addr->sin6_addr, addr_str, sizeof(addr_str)) == NULL) {
+            perror("inet_ntop");
+        } else {
+            printf("Received HELLO (session %08x). Sending HELLO ACK to: %s\n", header->session_id, addr_str);
+        }
+        // Auf stdout wird genau eine Übertragung geschrieben, weitere Sender bekommen kein HELLO ACK
+        if (!session && stream_fd >= 0 && session_count > 0) {
+            printf("Output to stdout is busy, HELLO of session %08x ignored.\n", header->session_id);
+            return;
+        }
+        queueControlPacket(sock, src_addr, src_addr_len, PKT_HELLO_ACK, header->session_id, 0, NULL, 0);
+        printf("HELLO ACK queued.\n");
+
+        // Ein wiederholtes HELLO setzt die bestehende Sitzung zurück, statt eine zweite anzulegen
+        if (!session) {
+            session = createSession(src_addr, src_addr_len, header->session_id);
+            printf("Session %08x created (%d active).\n", session->session_id, session_count);
+        }
+
+        // Das HELLO trägt die erste Sequenznummer des Senders
+        session->expected_seq = header->seq_num;
+        session->highest_seq = header->seq_num;
+        session->unacked = 0;
+        session->ack_due = -1;
+        clearReorderBuffer(session);
+        openOutput(&session->writer);
+        printf("Initial sequence number: %u.\n", session->expected_seq);
+
+        // Der Sender kündigt im HELLO an, ob er Binärblöcke statt Textzeilen überträgt
+        session->binary_mode = (header->flags & PKT_FLAG_BINARY) != 0;
+        printf("Transfer mode: %s.\n", session->binary_mode ? "binary" : "text");
+
+        // Mit PKT_FLAG_FEC trägt das HELLO Blockgröße und Paritätsanzahl
+        if ((header->flags & PKT_FLAG_FEC) && header->length == sizeof(struct fec_params)) {
+            struct fec_params params;
+            memcpy(&params, payload, sizeof(params));
+            setupFec(session, &params);
+        } else {
+            freeFec(session);
+        }
+        if (session->binary_mode && !separate_files && session_count > 1) {
+            printf("Warning: binary session %08x shares %s with other sessions (use -m).\n",
+                   session->session_id, output_file);
+        }
+    } else if (header->type == PKT_CLOSE) {
+        // Auch ohne Sitzung bestätigen, falls das erste CLOSE ACK verloren ging
+        printf("Received CLOSE (session %08x). Sending CLOSE ACK...\n", header->session_id);
+        queueControlPacket(sock, src_addr, src_addr_len, PKT_CLOSE_ACK, header->session_id, 0, NULL, 0);
+        printf("CLOSE ACK queued.\n");
+        if (session) {
+            removeSession(session);
+            printf("Session %08x closed (%d active).\n", header->session_id, session_count);
+
+            // Mit dem Schließen von stdout sieht der Leser das Dateiende; nach dem CLOSE ACK ist der Server fertig
+            if (stream_fd >= 0) {
+                stream_finished = true;
+            }
+        }
+    }
+}
+
+
+// Funktion zum Planen von NACKs für alle Pakete, die vor received_seq neu als fehlend erkannt wurden.
+// Jedes NACK wartet eine zufällige Zeit, damit bei vielen Empfängern meist nur einer nachfragt
+// und die anderen es über die Multicast-Gruppe hören (Unterdrückung wie bei SRM).
+void scheduleNacks(struct session *session, uint32_t received_seq) {
+    long long now = nowMicros();
+    uint32_t seq = seqLess(session->highest_seq, session->expected_seq) ? session->expected_seq : session->highest_seq;
+    for (; seqLess(seq, received_seq); seq++) {
+        struct reorder_entry *entry = &session->reorder_buffer[seq % REORDER_CAPACITY];
+        if (entry->occupied) {
+            continue;
+        }
+        entry->seq_num = seq;
+        entry->nack_due = now + rand() % (NACK_BACKOFF_MAX + 1) + (session->fec_data > 0 ? FEC_REPAIR_DELAY : 0);
+        if (session->nack_deadline < 0 || entry->nack_due < session->nack_deadline) {
+            session->nack_deadline = entry->nack_due;
+        }
+    }
+}
+
+// Funktion zum Zurückstellen der eigenen NACKs, wenn ein anderer Empfänger dieselben Pakete bereits angefordert hat
+void suppressNack(struct session *session, uint32_t seq_num) {
+    if (!seqInRange(seq_num, session->expected_seq, session->highest_seq)) {
+        return;
+    }
+    struct reorder_entry *entry = &session->reorder_buffer[seq_num % REORDER_CAPACITY];
+    if (!entry->occupied && entry->seq_num == seq_num && entry->nack_due != 0) {
+        entry->nack_due = nowMicros() + NACK_RETRY;
+        printf("NACK for sequence %u suppressed.\n", seq_num);
+    }
+}
+
+// Funktion zum Einreihen eines NACKs mit Bitmaske an den Sender und an die Gruppe.
+// Das NACK trägt die kumulative Bestätigung mit und ersetzt damit ein ausstehendes verzögertes ACK.
+void queueNack(int sock, struct session *session, uint32_t base, const uint8_t *bitmap, int bitmap_len) {
+    uint8_t payload[NACK_ACK_SIZE + NACK_BITMAP_BYTES];
+    uint32_t cumulative = htonl(session->expected_seq);
+    memcpy(payload, &cumulative, NACK_ACK_SIZE);
+    memcpy(payload + NACK_ACK_SIZE, bitmap, bitmap_len);
+
+    int length = NACK_ACK_SIZE + bitmap_len;
+    queueControlPacket(sock, &session->addr, session->addr_len, PKT_NACK, session->session_id, base, payload, length);
+    queueControlPacket(sock, &group_addr, sizeof(group_addr), PKT_NACK, session->session_id, base, payload, length);
+    session->unacked = 0;
+    session->ack_due = -1;
+
+    int extra = 0;
+    for (int i = 0; i < bitmap_len; i++) {
+        extra += __builtin_popcount(bitmap[i]);
+    }
+    printf("NACK for sequence %u (+%d more) queued.\n", base, extra);
+}
+
+// Funktion zum Senden fälliger NACKs einer Sitzung: an den Sender und an die Gruppe, damit andere
+// Empfänger ihr NACK unterdrücken. Alle fälligen Lücken innerhalb von NACK_BITMAP_BITS Paketen
+// werden in einem NACK zusammengefasst. Bleibt die Wiederholung aus, wird nach NACK_RETRY erneut gefragt.
+void sendDueNacks(int sock, struct session *session) {
+    long long now = nowMicros();
+    if (session->nack_deadline < 0 || session->nack_deadline > now) {
+        return;
+    }
+
+    uint8_t bitmap[NACK_BITMAP_BYTES];
+    int bitmap_len = 0;
+    uint32_t nack_base = 0;
+    bool pending = false;  // Gibt an, ob ein begonnenes NACK noch eingereiht werden muss
+
+    session->nack_deadline = -1;
+    for (uint32_t seq = session->expected_seq; seq != session->highest_seq; seq++) {
+        struct reorder_entry *entry = &session->reorder_buffer[seq % REORDER_CAPACITY];
+        if (entry->occupied || entry->seq_num != seq || entry->nack_due == 0) {
+            continue;
+        }
+        if (entry->nack_due <= now) {
+            if (pending && seq - nack_base <= NACK_BITMAP_BITS) {
+                int bit = (int)(seq - nack_base - 1);
+                bitmapSet(bitmap, bit);
+                bitmap_len = bit / 8 + 1;
+            } else {
+                if (pending) {
+                    queueNack(sock, session, nack_base, bitmap, bitmap_len);
+                }
+                pending = true;
+                nack_base = seq;
+                memset(bitmap, 0, sizeof(bitmap));
+                bitmap_len = 0;
+            }
+            entry->nack_due = now + NACK_RETRY;
+        }
+        if (session->nack_deadline < 0 || entry->nack_due < session->nack_deadline) {
+            session->nack_deadline = entry->nack_due;
+        }
+    }
+    if (pending) {
+        queueNack(sock, session, nack_base, bitmap, bitmap_len);
+    }
+}
+
+// Funktion zum Senden einer kumulativen Bestätigung (ACK) mit SACK-Bitmaske der vorgezogen gepufferten Pakete
+void sendAck(int sock, struct session *session) {
+    uint8_t bitmap[SACK_BITMAP_BYTES];
+    int bitmap_len = 0;
+    memset(bitmap, 0, sizeof(bitmap));
+
+    for (uint32_t seq = session->expected_seq + 1; seq != session->highest_seq; seq++) {
+        int bit = (int)(seq - session->expected_seq - 1);
+        if (bit >= SACK_BITMAP_BITS) {
+            break;
+        }
+        struct reorder_entry *entry = &session->reorder_buffer[seq % REORDER_CAPACITY];
+        if (entry->occupied && entry->seq_num == seq) {
+            bitmapSet(bitmap, bit);
+            bitmap_len = bit / 8 + 1;
+        }
+    }
+
+    queueControlPacket(sock, &session->addr, session->addr_len, PKT_ACK, session->session_id, session->expected_seq,
+                       bitmap, bitmap_len);
+    session->unacked = 0;
+    session->ack_due = -1;
+}
+
+// Funktion zum Vormerken einer Bestätigung nach einem Datenpaket (Delayed ACK).
+// Bestätigt wird nach ACK_EVERY Paketen, nach ACK_DELAY oder sofort, wenn der Sender schnell
+// Bescheid wissen muss (Duplikat: vermutlich ging ein ACK verloren; geschlossene Lücke).
+void scheduleAck(int sock, struct session *session, bool immediate) {
+    session->unacked++;
+    if (immediate || session->unacked >= ACK_EVERY) {
+        sendAck(sock, session);
+    } else if (session->ack_due < 0) {
+        session->ack_due = nowMicros() + ACK_DELAY;
+    }
+}
+
+// Funktion zum Abarbeiten aller Sitzungen, deren Schreib-, ACK- oder NACK-Zeitpunkt erreicht ist
+void processDueSessions(int sock) {
+    for (int i = 0; i < SESSION_BUCKETS; i++) {
+        for (struct session *session = sessions[i]; session; session = session->next) {
+            flushOutputIfDue(&session->writer);
+            sendDueNacks(sock, session);
+            if (session->ack_due >= 0 && session->ack_due <= nowMicros()) {
+                sendAck(sock, session);
+            }
+        }
+    }
+}
+
+// Funktion zur Überprüfung der Sequenznummern und Planung von NACKs
+// Vergleiche erfolgen mit Überlauf (RFC 1982), damit der 32-Bit-Sequenzraum umlaufen darf.
+void handleSequenceNumber(struct session *session, uint32_t received_seq) {
+    uint32_t expected_seq = session->expected_seq;
+    if (seqLess(received_seq, expected_seq)) {
+        // Bereits empfangenes Paket (Wiederholung), keine Lücke
+        printf("Duplicate packet. Expected: %u, Received: %u.\n", expected_seq, received_seq);
+    } else if (received_seq != expected_seq) {
+        // Lücke erkannt, NACKs für neu fehlende Pakete planen
+        printf("Sequence mismatch. Expected: %u, Received: %u.\n", expected_seq, received_seq);
+        if (received_seq - expected_seq < REORDER_CAPACITY) {
+            scheduleNacks(session, received_seq);
+        }
+    } else {
+        printf("Sequence match. Expected: %u, Received: %u.\n", expected_seq, received_seq);
+    }
+
+    if (seqLess(received_seq, expected_seq + REORDER_CAPACITY) && !seqLess(received_seq, session->highest_seq)) {
+        session->highest_seq = received_seq + 1;
+    }
+}
+
+// Funktion zum Suchen einer Sitzung nur anhand der Sitzungskennung (für NACKs anderer Empfänger)
+struct session *findSessionById(uint32_t session_id) {
+    for (int i = 0; i < SESSION_BUCKETS; i++) {
+        for (struct session *session = sessions[i]; session; session = session->next) {
+            if (session->session_id == session_id) {
+                return session;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Wiederhergestellte Pakete durchlaufen denselben Weg wie empfangene
+void processData(int sock, struct session *session, uint32_t received_seq, const char *payload, int length);
+
+// Funktion zum Suchen des Blockeintrags für start_seq; ein veralteter Eintrag an derselben Stelle wird neu initialisiert
+struct fec_block *fecBlock(struct session *session, uint32_t start_seq) {
+    uint32_t block_number = (start_seq - session->fec_base) / session->fec_data;
+    struct fec_block *block = &session->fec_blocks[block_number % session->fec_block_count];
+    if (!block->active || block->start_seq != start_seq) {
+        block->start_seq = start_seq;
+        block->active = true;
+        block->received = 0;
+        block->count = 0;
+        block->parity_received = 0;
+        memset(block->length_xor, 0, sizeof(block->length_xor));
+        memset(block->xor_data, 0, (size_t)session->fec_parity * session->fec_max_payload);
     }
+    return block;
+}
 
-    // Holt das aktuelle Datum und die aktuelle Uhrzeit
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+// Funktion zum Vorziehen des NACKs für ein Paket, das die Parität nicht reparieren kann
+void expediteNack(struct session *session, uint32_t seq_num) {
+    struct reorder_entry *entry = &session->reorder_buffer[seq_num % REORDER_CAPACITY];
+    long long due = nowMicros() + rand() % (NACK_BACKOFF_MAX + 1);
+    if (entry->occupied || entry->seq_num != seq_num || entry->nack_due == 0 || entry->nack_due <= due) {
+        return;
+    }
+    entry->nack_due = due;
+    if (session->nack_deadline < 0 || due < session->nack_deadline) {
+        session->nack_deadline = due;
+    }
+}
 
-    // Formatiert Datum und Uhrzeit
-    char time_str[64];
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", t);
+// Funktion zum Wiederherstellen verlorener Datenpakete eines Blocks. Fehlt in einer Paritätsklasse,
+// deren Paritätspaket eingetroffen ist, genau ein Datenpaket, ist es das XOR der Klasse.
+// Fehlen mehr oder ging das Paritätspaket der Klasse verloren, wird ohne FEC_REPAIR_DELAY nachgefragt.
+void fecRecover(int sock, struct session *session, struct fec_block *block) {
+    for (int j = 0; j < session->fec_parity; j++) {
+        int missing = -1;
+        int missing_count = 0;
+        for (int i = j; i < block->count; i += session->fec_parity) {
+            if (!(block->received & (1ULL << i))) {
+                missing = i;
+                missing_count++;
+            }
+        }
+        if (missing_count == 0) {
+            continue;
+        }
+        if (missing_count > 1 || !(block->parity_received & (1u << j))) {
+            for (int i = j; i < block->count; i += session->fec_parity) {
+                if (!(block->received & (1ULL << i))) {
+                    expediteNack(session, block->start_seq + i);
+                }
+            }
+            continue;
+        }
 
-    // Nachricht mit Zeitstempel in die Datei schreiben
-    fprintf(file, "%s - %s\n", time_str, message);
+        int length = block->length_xor[j];
+        if (length > session->fec_max_payload) {
+            printf("Parity for block %u inconsistent, recovery skipped.\n", block->start_seq);
+            continue;
+        }
 
-    fclose(file);  // Schließt die Datei
+        // Kopie, weil processData das Paket selbst wieder in den Klassenpuffer einrechnet
+        char recovered[FEC_MAX_DATA_PAYLOAD];
+        memcpy(recovered, block->xor_data + (size_t)j * session->fec_max_payload, length);
+        uint32_t seq_num = block->start_seq + missing;
+        printf("Recovered packet %u from parity.\n", seq_num);
+        processData(sock, session, seq_num, recovered, length);
+    }
 }
 
-// Funktion zur Verarbeitung von Kontrollnachrichten
-void handleControlMessage(const char *message, int sock, struct sockaddr_in6 *src_addr, socklen_t src_addr_len, int *expected_seq) {
-    if (strcmp(message, "HELLO") == 0) {
-        char addr_str[INET6_ADDRSTRLEN]; // Buffer für die IPv6-Adresse
-        if (inet_ntop(AF_INET6, &src_addr->sin6_addr, addr_str, sizeof(addr_str)) == NULL) {
-            perror("inet_ntop");
-        } else {
-            printf("Received HELLO. Sending HELLO ACK to: %s\n", addr_str);
-        }
-        sendto(sock, "HELLO ACK", strlen("HELLO ACK"), 0, (struct sockaddr *)src_addr, src_addr_len);
-        printf("HELLO ACK sent.\n");
-    } else if (strcmp(message, "CLOSE") == 0) {
-        printf("Received CLOSE. Sending CLOSE ACK...\n");
-        sendto(sock, "CLOSE ACK", strlen("CLOSE ACK"), 0, (struct sockaddr *)src_addr, src_addr_len);
-        printf("CLOSE ACK sent. Resetting expected sequence number to 0.\n");
-        *expected_seq = 0;  // Setze die erwartete Sequenznummer zurück
+// Funktion zum Einrechnen eines neu angenommenen Datenpakets in die Parität seines Blocks
+void fecAccumulate(int sock, struct session *session, uint32_t seq_num, const char *payload, int length) {
+    if (session->fec_data == 0 || length > session->fec_max_payload) {
+        return;
+    }
+
+    uint32_t offset = seq_num - session->fec_base;
+    int position = (int)(offset % session->fec_data);
+    struct fec_block *block = fecBlock(session, seq_num - position);
+    if (block->received & (1ULL << position)) {
+        return;
     }
+
+    int j = position % session->fec_parity;
+    xorBytes(block->xor_data + (size_t)j * session->fec_max_payload, (const uint8_t *)payload, length);
+    block->length_xor[j] ^= (uint16_t)length;
+    block->received |= 1ULL << position;
+    fecRecover(sock, session, block);
 }
 
+// Funktion zur Verarbeitung eines Paritätspakets: Seq-Nummer ist der Blockanfang,
+// die Nutzdaten beginnen mit einem fec_header
+void handleParity(int sock, struct session *session, uint32_t start_seq, const char *payload, int length) {
+    if (session->fec_data == 0 || length < FEC_HEADER_SIZE) {
+        return;
+    }
+
+    struct fec_header fec;
+    memcpy(&fec, payload, FEC_HEADER_SIZE);
+    int count = ntohs(fec.count);
+    int data_len = length - FEC_HEADER_SIZE;
+    if (fec.index >= session->fec_parity || fec.stride != session->fec_parity || count < 1 ||
+        count > session->fec_data || data_len > session->fec_max_payload ||
+        (start_seq - session->fec_base) % session->fec_data != 0) {
+        printf("Malformed parity packet for block %u ignored.\n", start_seq);
+        return;
+    }
+
+    // Vollständig ausgelieferte Blöcke und Blöcke jenseits des Umordnungspuffers brauchen keine Parität
+    if (!seqLess(session->expected_seq, start_seq + count) ||
+        !seqLess(start_seq, session->expected_seq + REORDER_CAPACITY)) {
+        return;
+    }
+
+    struct fec_block *block = fecBlock(session, start_seq);
+    if (block->parity_received & (1u << fec.index)) {
+        return;
+    }
+    xorBytes(block->xor_data + (size_t)fec.index * session->fec_max_payload,
+             (const uint8_t *)payload + FEC_HEADER_SIZE, data_len);
+    block->length_xor[fec.index] ^= ntohs(fec.length_xor);
+    block->parity_received |= (uint16_t)(1u << fec.index);
+    block->count = count;
+    fecRecover(sock, session, block);
+}
 
-// Funktion zur Überprüfung der Sequenznummern und Generierung von NACKs
-void handleSequenceNumber(int sock, struct sockaddr_in6 *src_addr, socklen_t src_addr_len, int expected_seq, int received_seq) {
-    if (received_seq != expected_seq) {
-        // Lücke erkannt, sende NACK
-        printf("Sequence mismatch. Expected: %d, Received: %d. Sending NACK...\n", expected_seq, received_seq);
-        char nack_msg[BUF_SIZE];
-        snprintf(nack_msg, sizeof(nack_msg), "NACK:%d", expected_seq);
+// Funktion zur Verarbeitung eines Datenpakets, empfangen oder aus der Parität wiederhergestellt
+void processData(int sock, struct session *session, uint32_t received_seq, const char *payload, int length) {
+    // Überprüfen der Sequenznummer und Generierung von NACKs bei Bedarf
+    handleSequenceNumber(session, received_seq);
 
-        if (sendto(sock, nack_msg, strlen(nack_msg), 0, (struct sockaddr *)src_addr, src_addr_len) < 0) {
-            perror("sendto (NACK)");
+    if (seqLess(received_seq, session->expected_seq)) {
+        // Bereits ausgeliefert: sofort erneut bestätigen, falls das erste ACK verloren ging
+        scheduleAck(sock, session, true);
+    } else if (received_seq - session->expected_seq >= REORDER_CAPACITY) {
+        // Außerhalb des Umordnungspuffers: verwerfen, ohne zu bestätigen
+        printf("Packet %u beyond reorder buffer dropped (expected %u).\n", received_seq, session->expected_seq);
+    } else if (received_seq == session->expected_seq) {
+        // Erwartetes Paket ausliefern und anschließende gepufferte Pakete nachziehen
+        deliverPayload(session, received_seq, payload, length);
+        session->expected_seq++;
+        flushReorderBuffer(session);
+        scheduleAck(sock, session, session->expected_seq != received_seq + 1);
+        fecAccumulate(sock, session, received_seq, payload, length);
+    } else {
+        // Vorgezogenes Paket bis zum Schließen der Lücke puffern
+        bool buffered = bufferPacket(session, received_seq, payload, length);
+        if (buffered) {
+            printf("Out of order packet buffered: expected %u, got %u\n", session->expected_seq, received_seq);
+            fecAccumulate(sock, session, received_seq, payload, length);
         } else {
-            printf("NACK for sequence %d sent.\n", expected_seq);
+            printf("Duplicate packet %u dropped.\n", received_seq);
         }
-    } else {
-        printf("Sequence match. Expected: %d, Received: %d.\n", expected_seq, received_seq);
+        scheduleAck(sock, session, !buffered);
     }
 }
 
-int main(int argc, char *argv[]) {
-    // Überprüfung der Argumentanzahl
-    if (argc != 4) {
-        usage();
+// Funktion zur Verarbeitung eines empfangenen Datagramms
+void processPacket(int sock, const char *buffer, int len, struct sockaddr_in6 *src_addr, socklen_t src_addr_len) {
+    // Prüfen und Zerlegen des Binärkopfs
+    struct packet_header header;
+    const char *payload;
+    if (parsePacket(buffer, len, &header, &payload) < 0) {
+        printf("Malformed packet (%d bytes) ignored.\n", len);
+        return;
     }
+    printf("Received %s packet (session %08x, seq %u, %u bytes).\n", packetTypeName(header.type),
+           header.session_id, header.seq_num, header.length);
 
-    // Einlesen der Kommandozeilenargumente
-    char *multicast_addr = argv[1];  // IPv6-Multicast-Adresse
-    int port = atoi(argv[2]);        // Portnummer
-    char *output_file = argv[3];     // Name der Ausgabedatei
+    // Prüfen auf Kontrollnachrichten
+    if (header.type == PKT_HELLO || header.type == PKT_CLOSE) {
+        handleControlMessage(&header, payload, sock, src_addr, src_addr_len);
+        return;
+    }
+    if (header.type == PKT_NACK) {
+        // Von einem anderen Empfänger an die Gruppe gesendetes NACK: eigene NACKs für dieselben Pakete zurückstellen
+        struct session *session = findSessionById(header.session_id);
+        if (session && header.length >= NACK_ACK_SIZE && header.length <= NACK_ACK_SIZE + NACK_BITMAP_BYTES) {
+            suppressNack(session, header.seq_num);
+            const uint8_t *bitmap = (const uint8_t *)payload + NACK_ACK_SIZE;
+            for (int bit = 0; bit < (header.length - NACK_ACK_SIZE) * 8; bit++) {
+                if (bitmapTest(bitmap, bit)) {
+                    suppressNack(session, header.seq_num + 1 + bit);
+                }
+            }
+        }
+        return;
+    }
+    if (header.type != PKT_DATA && header.type != PKT_PARITY) {
+        return;
+    }
+
+    // Daten- und Paritätspakete ohne vorheriges HELLO gehören zu keiner Sitzung
+    struct session *session = findSession(src_addr, header.session_id);
+    if (!session) {
+        printf("Packet for unknown session %08x ignored.\n", header.session_id);
+        return;
+    }
+
+    if (header.type == PKT_PARITY) {
+        handleParity(sock, session, header.seq_num, payload, header.length);
+    } else {
+        processData(sock, session, header.seq_num, payload, header.length);
+    }
+}
 
+// Funktion zum Erstellen eines an den Port gebundenen Sockets, der der Multicast-Gruppe beitritt
+int createReceiverSocket(const char *multicast_addr, int port) {
     // Erstellen des Sockets für UDPv6
     int sock = socket(AF_INET6, SOCK_DGRAM, 0);
     if (sock < 0) {
@@ -114,7 +1392,7 @@ int main(int argc, char *argv[]) {
     }
 
     #ifdef SO_REUSEPORT
-    // Aktiviert die Wiederverwendung des Ports (falls verfügbar)
+    // Aktiviert die Wiederverwendung des Ports (falls verfügbar), damit mehrere Server auf einem Rechner empfangen können
     if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
         perror("setsockopt(SO_REUSEPORT)");
         close(sock);
@@ -146,92 +1424,734 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    // Zusammenfassen gleich großer Datagramme durch den Kernel (UDP GRO), sonst einzelne Datagramme empfangen
+    if (setsockopt(sock, SOL_UDP, UDP_GRO, &optval, sizeof(optval)) < 0) {
+        printf("UDP GRO not available, receiving single datagrams.\n");
+        gro_enabled = false;
+    } else {
+        gro_enabled = true;
+    }
+
     printf("Joined multicast group %s. Waiting for messages...\n", multicast_addr);
+    return sock;
+}
+
+// Funktion zum Bestimmen des Workers, der ein Datagramm verarbeitet, -1 für alle Worker.
+// Ausgewertet wird nur der Kopf, die Prüfsumme berechnet erst der Worker. Zu kurze Pakete meldet Worker 0.
+int dispatchTarget(const char *buffer, int len, const struct sockaddr_in6 *src_addr) {
+    if (len < HEADER_SIZE) {
+        return 0;
+    }
 
-    char buffer[BUF_SIZE];  // Puffer für eingehende Nachrichten
-    int expected_seq = 0;   // Nächste erwartete Sequenznummer
-    fd_set readfds;  // Datei-Deskriptoren-Menge für select()
-    struct timeval timeout;  // Timeout für select()
+    // NACKs anderer Empfänger tragen nicht die Adresse des Senders, jeder Worker sucht die Sitzung selbst
+    if (((const struct packet_header *)buffer)->type == PKT_NACK) {
+        return -1;
+    }
 
+    uint32_t session_id;
+    memcpy(&session_id, buffer + offsetof(struct packet_header, session_id), sizeof(session_id));
+    return (int)(sessionHash(src_addr, ntohl(session_id)) % worker_count);
+}
 
-    // Endlosschleife für den Empfang von Multicast-Nachrichten
-    while (1) {
-        FD_ZERO(&readfds);  // Löscht die Deskriptoren-Menge
-        FD_SET(sock, &readfds);  // Fügt den Server-Socket zur Überwachung hinzu
+// Funktion zum Einreihen eines Datagramms in die Warteschlange von Worker w. Ist sie voll, wird das
+// Datagramm verworfen wie bei einem vollen Socket-Puffer; der Sender wiederholt es nach einem NACK.
+bool enqueueDatagram(int w, struct packet_buffer *packet, char *data, int len, const struct sockaddr_in6 *src_addr,
+                     socklen_t src_addr_len, int segment) {
+    struct dispatch_queue *queue = &dispatch_queues[w];
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&queue->head, memory_order_acquire) == DISPATCH_QUEUE_SIZE) {
+        printf("Queue of worker %d full, datagram dropped.\n", w);
+        return false;
+    }
+
+    struct dispatch_entry *entry = &queue->entries[tail & (DISPATCH_QUEUE_SIZE - 1)];
+    entry->packet = packet;
+    entry->data = data;
+    entry->len = len;
+    entry->segment = segment;
+    entry->addr = *src_addr;
+    entry->addr_len = src_addr_len;
+    packet->handed_off = true;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    dispatch_pending |= 1ULL << w;
+    return true;
+}
 
-        timeout.tv_sec = 5;  // Timeout von 5 Sekunden
-        timeout.tv_usec = 0;
+// Funktion zum Verteilen des gerade empfangenen Datagramms (current_packet) an den Worker seiner Sitzung.
+// Ein per GRO zusammengefasstes Datagramm stammt von einem Socket des Senders und geht als Ganzes an
+// einen Worker. NACKs an die Gruppe bekommt jeder Worker als eigene Kopie.
+void dispatchDatagram(char *datagram, int len, const struct sockaddr_in6 *src_addr, socklen_t src_addr_len,
+                      int segment) {
+    int target = dispatchTarget(datagram, len, src_addr);
+    if (target >= 0) {
+        enqueueDatagram(target, current_packet, datagram, len, src_addr, src_addr_len, segment);
+        return;
+    }
+    for (int w = 0; w < worker_count; w++) {
+        struct packet_buffer *copy = acquirePacket();
+        memcpy(copy->data, datagram, len);
+        if (!enqueueDatagram(w, copy, copy->data, len, src_addr, src_addr_len, segment)) {
+            releasePacket(copy);
+        }
+    }
+}
 
-        printf("Waiting for incoming messages...\n");
+// Funktion zum Wecken aller Worker, denen seit dem letzten Aufruf Datagramme übergeben wurden
+void wakeWorkers() {
+    while (dispatch_pending) {
+        int w = __builtin_ctzll(dispatch_pending);
+        dispatch_pending &= dispatch_pending - 1;
+        uint64_t signal = 1;
+        if (write(dispatch_queues[w].event_fd, &signal, sizeof(signal)) < 0) {
+            perror("write (eventfd)");
+        }
+    }
+}
 
-        int activity = select(sock + 1, &readfds, NULL, NULL, &timeout);
+// Funktion zum Bestimmen der Segmentgröße eines per UDP GRO zusammengefassten Datagramms, 0 wenn es nur ein Paket enthält
+int groSegmentSize(struct msghdr *msg) {
+    if (!gro_enabled) {
+        return 0;
+    }
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment;
+            memcpy(&segment, CMSG_DATA(cmsg), sizeof(segment));
+            return segment;
+        }
+    }
+    return 0;
+}
 
-        if (activity < 0) {
-            perror("select");
-            break;
+// Funktion zur Verarbeitung eines empfangenen Datagramms. Ein per GRO zusammengefasstes Datagramm
+// (segment > 0) wird in die einzelnen Pakete zerlegt. Der Verteiler reicht es stattdessen an einen Worker weiter.
+void processDatagram(int sock, char *datagram, int len, struct sockaddr_in6 *src_addr, socklen_t src_addr_len,
+                     int segment) {
+    if (dispatching) {
+        dispatchDatagram(datagram, len, src_addr, src_addr_len, segment);
+        return;
+    }
+    if (segment <= 0 || segment > len) {
+        segment = len;
+    }
+    int offset = 0;
+    do {
+        int part = len - offset < segment ? len - offset : segment;
+        processPacket(sock, datagram + offset, part, src_addr, src_addr_len);
+        offset += segment;
+    } while (offset < len);
+}
+
+// Funktion zum Beenden aller Sitzungen des aufrufenden Threads
+void closeAllSessions() {
+    for (int i = 0; i < SESSION_BUCKETS; i++) {
+        while (sessions[i]) {
+            removeSession(sessions[i]);
         }
+    }
+}
+
+// Funktion zum Starten des Multishot-Empfangs: ein einziger SQE liefert Abschlüsse für alle folgenden
+// Datagramme, jeweils in einem vom Kernel gewählten Puffer der Gruppe
+void armReceive(int sock, struct msghdr *layout, struct uring_buffers *buffers) {
+    struct io_uring_sqe *sqe = uringGetSqe(uring);
+    if (!sqe) {
+        perror("io_uring_enter");
+        exit(EXIT_FAILURE);
+    }
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = sock;
+    sqe->addr = (uint64_t)(uintptr_t)layout;
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffers->group;
+    sqe->user_data = 0;  // Schreibaufträge tragen ihre Kette als user_data
+}
+
+// Funktion zur Verarbeitung eines Multishot-Empfangspuffers: io_uring_recvmsg_out, Adresse und
+// Steuerdaten in der in layout angegebenen Länge, danach das Datagramm
+void handleReceiveBuffer(int sock, char *buffer, struct msghdr *layout) {
+    struct io_uring_recvmsg_out out;
+    memcpy(&out, buffer, sizeof(out));
+    if (out.flags & MSG_TRUNC) {
+        printf("Truncated datagram ignored.\n");
+        return;
+    }
+
+    // Adresse und Steuerdaten liegen nicht ausgerichtet im Puffer
+    struct sockaddr_in6 src_addr;
+    union {
+        struct cmsghdr align;
+        char data[CMSG_SPACE(sizeof(int))];
+    } control;
+    char *name = buffer + sizeof(out);
+    char *control_data = name + layout->msg_namelen;
+    char *payload = control_data + layout->msg_controllen;
+    socklen_t name_len = out.namelen < sizeof(src_addr) ? out.namelen : sizeof(src_addr);
+    size_t control_len = out.controllen < sizeof(control) ? out.controllen : sizeof(control);
+    memset(&src_addr, 0, sizeof(src_addr));
+    memcpy(&src_addr, name, name_len);
+    memcpy(control.data, control_data, control_len);
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control.data;
+    msg.msg_controllen = control_len;
+    processDatagram(sock, payload, (int)out.payloadlen, &src_addr, name_len, groSegmentSize(&msg));
+}
 
-        if (activity == 0) {
-            printf("\n Timeout: No messages received within 5 seconds.\n");
-            continue;  // Zurück zum Anfang der Schleife
+// Funktion zum Abarbeiten aller vorliegenden Abschlüsse: Empfänge werden verarbeitet und ihre Puffer
+// zurückgegeben, Schreibaufträge fortgesetzt. Mit receive = false werden Empfänge nur verworfen.
+// packets enthält die dem Kernel unter der jeweiligen Nummer bereitgestellten Paketpuffer.
+// Gibt -1 zurück, wenn der Empfang mit einem Fehler endete; er wird dann nicht neu gestartet.
+int processCompletions(int sock, int reply_sock, struct msghdr *layout, struct uring_buffers *buffers,
+                       struct packet_buffer **packets, bool receive) {
+    int status = 0;
+    struct io_uring_cqe *cqe;
+    while ((cqe = uringPeekCqe(uring))) {
+        uint64_t user_data = cqe->user_data;
+        int result = cqe->res;
+        unsigned flags = cqe->flags;
+        uringCqeSeen(uring);
+
+        if (user_data != 0) {
+            completeJob((struct write_chain *)(uintptr_t)user_data, result);
+            continue;
         }
 
-        if (FD_ISSET(sock, &readfds)) {
-            struct sockaddr_in6 src_addr;  // Absenderadresse
-            socklen_t src_addr_len = sizeof(src_addr);
-        
-            // Empfang eines Pakets
-            ssize_t len = recvfrom(sock, buffer, sizeof(buffer) - 1, 0, (struct sockaddr *)&src_addr, &src_addr_len);
-            if (len < 0) {
-                perror("recvfrom");
-                break;
+        if (flags & IORING_CQE_F_BUFFER) {
+            unsigned short bid = (unsigned short)(flags >> IORING_CQE_BUFFER_SHIFT);
+            if (receive && result >= 0) {
+                current_packet = packets[bid];
+                handleReceiveBuffer(reply_sock, packets[bid]->data, layout);
+                current_packet = NULL;
+                replaceRetained(&packets[bid]);
             }
+            uringProvideBuffer(buffers, bid, packets[bid]->data);
+        } else if (result < 0 && result != -ENOBUFS) {
+            // z. B. EINVAL auf Kerneln ohne Multishot-recvmsg; ein neuer Auftrag würde genauso scheitern
+            errno = -result;
+            perror("recvmsg (io_uring)");
+            status = -1;
+            continue;
+        }
+
+        // Ohne IORING_CQE_F_MORE ist der Multishot-Empfang beendet (z. B. alle Puffer belegt) und wird neu gestartet
+        if (!(flags & IORING_CQE_F_MORE) && receive) {
+            armReceive(sock, layout, buffers);
+        }
+    }
+    return status;
+}
+
+// Funktion zum Freigeben von Ring, Pufferring und Empfangspuffern des io_uring-Backends
+void stopUring(struct uring *ring, struct uring_buffers *buffers, struct packet_buffer **packets) {
+    uring = NULL;
+    uringExit(ring);
+    uringFreeBuffers(buffers);
+    for (int i = 0; i < URING_BUFFERS; i++) {
+        releasePacket(packets[i]);
+    }
+}
+
+// Ereignisschleife mit io_uring: Multishot-Empfang über bereitgestellte Puffer und asynchrones Schreiben
+// der Ausgabe, damit ein langsamer Datenträger den Empfang nicht aufhält. Gibt -1 zurück, wenn der
+// Kernel io_uring nicht unterstützt; dann übernimmt die epoll-Schleife.
+int runUringLoop(int sock, int reply_sock) {
+    struct uring ring;
+    if (uringInit(&ring, URING_ENTRIES) < 0) {
+        printf("io_uring not available (%s), using epoll.\n", strerror(errno));
+        return -1;
+    }
+
+    // Pufferlayout eines Multishot-Empfangs: Kopf, Adresse, Steuerdaten (UDP_GRO) und Datagramm
+    // (der Paketpuffer-Pool hält dafür Platz vor)
+    struct msghdr layout;
+    memset(&layout, 0, sizeof(layout));
+    layout.msg_namelen = sizeof(struct sockaddr_in6);
+    layout.msg_controllen = gro_enabled ? CMSG_SPACE(sizeof(int)) : 0;
+
+    struct uring_buffers buffers;
+    if (uringSetupBuffers(&ring, &buffers, URING_BUFFERS, pool_buffer_size, 0) < 0) {
+        printf("io_uring buffer rings not available (%s), using epoll.\n", strerror(errno));
+        uringExit(&ring);
+        return -1;
+    }
+    struct packet_buffer *packets[URING_BUFFERS];
+    for (int i = 0; i < URING_BUFFERS; i++) {
+        packets[i] = acquirePacket();
+        uringProvideBuffer(&buffers, (unsigned short)i, packets[i]->data);
+    }
+    uring = &ring;
+    armReceive(sock, &layout, &buffers);
+
+    // Kernel ohne Multishot-recvmsg (vor 6.0) lehnen den Auftrag gleich bei der Übergabe ab
+    int ret = uringSubmitAndWait(&ring, 0, -1);
+    if (ret < 0 || processCompletions(sock, reply_sock, &layout, &buffers, packets, true) < 0) {
+        printf("io_uring multishot receive not available, using epoll.\n");
+        stopUring(&ring, &buffers, packets);
+        return -1;
+    }
+    printf("Using io_uring backend.\n");
+
+    while (!stream_finished) {
+        // Übergeben und warten, höchstens bis zum nächsten Schreib-, ACK- oder NACK-Zeitpunkt
+        long long deadline = nextSessionDeadline();
+        long long timeout = -1;
+        if (deadline >= 0) {
+            long long now = nowMicros();
+            timeout = deadline > now ? deadline - now : 0;
+        }
+        ret = uringSubmitAndWait(&ring, 1, timeout);
+        if (ret < 0 && ret != -ETIME && ret != -EINTR && ret != -EBUSY) {
+            errno = -ret;
+            perror("io_uring_enter");
+            break;
+        }
+
+        int status = processCompletions(sock, reply_sock, &layout, &buffers, packets, true);
+
+        // Alle bei der Verarbeitung entstandenen ACKs/NACKs gemeinsam senden bzw. die Worker wecken
+        wakeWorkers();
+        flushControlPackets(reply_sock);
+        processDueSessions(reply_sock);
+        flushControlPackets(reply_sock);
+        if (status < 0) {
+            break;
+        }
+    }
+
+    // Sitzungen beenden und warten, bis alle Dateien geschrieben und geschlossen sind
+    closeAllSessions();
+    while (uring_chains > 0) {
+        int wait_ret = uringSubmitAndWait(&ring, 1, -1);
+        if (wait_ret < 0 && wait_ret != -EINTR) {
+            break;
+        }
+        processCompletions(sock, reply_sock, &layout, &buffers, packets, false);
+    }
+    stopUring(&ring, &buffers, packets);
+    return 0;
+}
+
+// Ereignisschleife eines Empfangssockets: Datagramme verarbeiten und Ausgabepuffer zeitgesteuert schreiben
+void runEventLoop(int sock) {
+    // Antworten gehen über einen eigenen Socket mit flüchtigem Port hinaus, damit der Sender
+    // mehrere Empfänger auf demselben Rechner an Adresse und Port unterscheiden kann
+    int reply_sock = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (reply_sock < 0) {
+        perror("socket (reply)");
+        exit(EXIT_FAILURE);
+    }
 
-            buffer[len] = '\0';  // Null-Terminierung des empfangenen Pakets
-            printf("Received message: %s\n", buffer);
+    if (use_uring && runUringLoop(sock, reply_sock) == 0) {
+        close(reply_sock);
+        return;
+    }
+
+    // epoll-Instanz: Socket flankengesteuert, timerfd für das zeitgesteuerte Schreiben der Ausgabe
+    int epoll_fd = epoll_create1(0);
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (epoll_fd < 0 || timer_fd < 0) {
+        perror("epoll_create1/timerfd_create");
+        close(sock);
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = sock;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &event) < 0) {
+        perror("epoll_ctl (socket)");
+        close(sock);
+        exit(EXIT_FAILURE);
+    }
+    event.events = EPOLLIN;
+    event.data.fd = timer_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) < 0) {
+        perror("epoll_ctl (timerfd)");
+        close(sock);
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event events[MAX_EVENTS];  // Von epoll_wait() gemeldete Ereignisse
+    long long timer_deadline = -1;          // Zeitpunkt, auf den der timerfd gestellt ist, -1 wenn nicht gestellt
+    bool running = true;
+
+    // Endlosschleife für den Empfang von Multicast-Nachrichten
+    while (running && !stream_finished) {
+        // Liegen ungeschriebene Daten in einem Ausgabepuffer oder sind NACKs geplant, den timerfd
+        // auf den frühesten Zeitpunkt stellen. Sonst schläft der Server, bis ein Paket eintrifft.
+        long long deadline = nextSessionDeadline();
+        if (deadline >= 0 && (timer_deadline < 0 || deadline < timer_deadline)) {
+            setTimerFd(timer_fd, deadline);
+            timer_deadline = deadline;
+        }
 
-            // Prüfen auf Kontrollnachrichten
-            if (strcmp(buffer, "HELLO") == 0 || strcmp(buffer, "CLOSE") == 0) {
-                handleControlMessage(buffer, sock, &src_addr, src_addr_len, &expected_seq);
-                if (strcmp(buffer, "CLOSE") == 0) {
-                    printf("Reset expected sequence number to 0 after CLOSE ACK.\n");
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int e = 0; e < count; e++) {
+            if (events[e].data.fd == timer_fd) {
+                uint64_t expirations;
+                if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+                    perror("read (timerfd)");
                 }
+                timer_deadline = -1;
+                processDueSessions(reply_sock);
+                flushControlPackets(reply_sock);
                 continue;
             }
 
+            // Flankengesteuert: Socket leeren, bis recvmmsg() weniger als RECV_BATCH Pakete liefert
+            while (1) {
+                for (int i = 0; i < RECV_BATCH; i++) {
+                    recv_msgs[i].msg_hdr.msg_namelen = sizeof(recv_addrs[i]);
+                    recv_msgs[i].msg_hdr.msg_control = gro_enabled ? recv_controls[i] : NULL;
+                    recv_msgs[i].msg_hdr.msg_controllen = gro_enabled ? sizeof(recv_controls[i]) : 0;
+                }
+                int received = recvmmsg(sock, recv_msgs, RECV_BATCH, MSG_DONTWAIT, NULL);
+                if (received < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        perror("recvmmsg");
+                        running = false;
+                    }
+                    break;
+                }
 
-            // Extrahieren der Sequenznummer
-            int received_seq;
-            char *payload = strchr(buffer, ':');
-            if (payload) {
-                *payload = '\0';  // Trennt die Sequenznummer vom Payload
-                payload++;
-                received_seq = atoi(buffer);
-            } else {
-                printf("Malformed packet: %s\n", buffer);
+                for (int i = 0; i < received; i++) {
+                    current_packet = recv_packets[i];
+                    processDatagram(reply_sock, recv_packets[i]->data, (int)recv_msgs[i].msg_len,
+                                    &recv_addrs[i], recv_msgs[i].msg_hdr.msg_namelen,
+                                    groSegmentSize(&recv_msgs[i].msg_hdr));
+                    current_packet = NULL;
+
+                    // Referenzierte Puffer bleiben beim Umordnungspuffer, der nächste Empfang nutzt einen neuen
+                    if (replaceRetained(&recv_packets[i])) {
+                        recv_iovs[i].iov_base = recv_packets[i]->data;
+                    }
+                }
+
+                // Alle bei der Verarbeitung entstandenen ACKs/NACKs gemeinsam senden bzw. die Worker wecken
+                wakeWorkers();
+                flushControlPackets(reply_sock);
+
+                if (received < RECV_BATCH) {
+                    break;
+                }
+            }
+            processDueSessions(reply_sock);
+            flushControlPackets(reply_sock);
+        }
+    }
+
+    close(timer_fd);
+    close(epoll_fd);
+    close(reply_sock);
+}
+
+// Ereignisschleife eines Workers: vom Verteiler übergebene Datagramme verarbeiten und
+// Ausgabepuffer, ACKs und NACKs zeitgesteuert abarbeiten
+void runWorkerLoop() {
+    int reply_sock = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (reply_sock < 0) {
+        perror("socket (reply)");
+        exit(EXIT_FAILURE);
+    }
+
+    // epoll-Instanz: eventfd der Warteschlange, timerfd für das zeitgesteuerte Schreiben der Ausgabe
+    int epoll_fd = epoll_create1(0);
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (epoll_fd < 0 || timer_fd < 0) {
+        perror("epoll_create1/timerfd_create");
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = dispatch_queue->event_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, dispatch_queue->event_fd, &event) < 0) {
+        perror("epoll_ctl (eventfd)");
+        exit(EXIT_FAILURE);
+    }
+    event.data.fd = timer_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event) < 0) {
+        perror("epoll_ctl (timerfd)");
+        exit(EXIT_FAILURE);
+    }
+
+    struct epoll_event events[MAX_EVENTS];  // Von epoll_wait() gemeldete Ereignisse
+    long long timer_deadline = -1;          // Zeitpunkt, auf den der timerfd gestellt ist, -1 wenn nicht gestellt
+
+    while (!atomic_load(&dispatch_stop)) {
+        long long deadline = nextSessionDeadline();
+        if (deadline >= 0 && (timer_deadline < 0 || deadline < timer_deadline)) {
+            setTimerFd(timer_fd, deadline);
+            timer_deadline = deadline;
+        }
+
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
                 continue;
             }
-            // Überprüfen der Sequenznummer und Generierung von NACKs bei Bedarf
-            handleSequenceNumber(sock, &src_addr, src_addr_len, expected_seq, received_seq);
+            perror("epoll_wait");
+            break;
+        }
 
-            // Protokollieren der empfangenen Nachricht
-            char log_msg[BUF_SIZE];
-            snprintf(log_msg, sizeof(log_msg), "Seq %d: %s", received_seq, payload);
-            logMessageToFile(output_file, log_msg);
+        for (int e = 0; e < count; e++) {
+            uint64_t signals;
+            if (read(events[e].data.fd, &signals, sizeof(signals)) < 0 && errno != EAGAIN) {
+                perror("read (eventfd/timerfd)");
+            }
+            if (events[e].data.fd == timer_fd) {
+                timer_deadline = -1;
+                continue;
+            }
 
-            // Aktualisieren der erwarteten Sequenznummer
-            if (received_seq == expected_seq) {
-                expected_seq++;
-            } else {
-                printf("Out of order packet: expected %d, got %d\n", expected_seq, received_seq);
+            // Warteschlange leeren; der Verteiler weckt erneut, wenn danach weitere Datagramme eintreffen
+            size_t head = atomic_load_explicit(&dispatch_queue->head, memory_order_relaxed);
+            while (head != atomic_load_explicit(&dispatch_queue->tail, memory_order_acquire)) {
+                struct dispatch_entry *entry = &dispatch_queue->entries[head & (DISPATCH_QUEUE_SIZE - 1)];
+                current_packet = entry->packet;
+                processDatagram(reply_sock, entry->data, entry->len, &entry->addr, entry->addr_len, entry->segment);
+                current_packet = NULL;
+                releasePacket(entry->packet);
+                head++;
+                atomic_store_explicit(&dispatch_queue->head, head, memory_order_release);
+            }
+        }
+
+        // Alle bei der Verarbeitung entstandenen ACKs/NACKs gemeinsam senden
+        processDueSessions(reply_sock);
+        flushControlPackets(reply_sock);
+    }
+
+    close(timer_fd);
+    close(epoll_fd);
+    close(reply_sock);
+}
+
+// Hauptfunktion eines Worker-Threads: eigene Sitzungstabelle, Datagramme vom Verteiler, Ausgabe über den Schreib-Thread
+void *workerThread(void *arg) {
+    worker_index = (int)(intptr_t)arg;
+    write_queue = &write_queues[worker_index];
+    dispatch_queue = &dispatch_queues[worker_index];
+
+    initBatches(false);
+    runWorkerLoop();
+
+    closeAllSessions();
+    freeBatches();
+    return NULL;
+}
+
+// Hauptfunktion des Schreib-Threads: leert die Warteschlangen aller Worker in Reihenfolge
+void *writerThread(void *arg) {
+    (void)arg;
+    while (1) {
+        bool idle = true;
+        for (int w = 0; w < worker_count; w++) {
+            struct write_queue *queue = &write_queues[w];
+            size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+            while (head != atomic_load_explicit(&queue->tail, memory_order_acquire)) {
+                struct write_request *request = &queue->entries[head & (WRITE_QUEUE_SIZE - 1)];
+                if (request->op == WRITE_DATA) {
+                    writeBuffer(request->fd, request->data, request->len);
+                    free(request->data);
+                    if (fsync_policy == FSYNC_FLUSH) {
+                        syncOutput(request->fd);
+                    }
+                } else {
+                    if (fsync_policy != FSYNC_NONE) {
+                        syncOutput(request->fd);
+                    }
+                    close(request->fd);
+                }
+                head++;
+                atomic_store_explicit(&queue->head, head, memory_order_release);
+                idle = false;
+            }
+        }
+
+        if (idle) {
+            if (atomic_load(&writer_stop)) {
+                break;
             }
+            // Blockieren, bis ein Worker neue Aufträge meldet
+            uint64_t signals;
+            if (read(writer_event_fd, &signals, sizeof(signals)) < 0 && errno != EINTR) {
+                perror("read (eventfd)");
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    // Optionen einlesen
+    int opt;
+    while ((opt = getopt(argc, argv, "f:mrt:u")) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "none") == 0) {
+                    fsync_policy = FSYNC_NONE;
+                } else if (strcmp(optarg, "close") == 0) {
+                    fsync_policy = FSYNC_CLOSE;
+                } else if (strcmp(optarg, "flush") == 0) {
+                    fsync_policy = FSYNC_FLUSH;
+                } else {
+                    usage();
+                }
+                break;
+            case 'u':
+                use_uring = true;
+                break;
+            case 'm':
+                separate_files = true;
+                break;
+            case 'r':
+                raw_output = true;
+                break;
+            case 't':
+                worker_count = atoi(optarg);
+                if (worker_count < 1 || worker_count > MAX_WORKERS) {
+                    printf("Worker count must be between 1 and %d.\n", MAX_WORKERS);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            default:
+                usage();
+        }
+    }
+
+    // Überprüfung der Argumentanzahl
+    if (argc - optind != 3) {
+        usage();
+    }
+
+    // Einlesen der Kommandozeilenargumente
+    multicast_group = argv[optind];           // IPv6-Multicast-Adresse
+    listen_port = atoi(argv[optind + 1]);     // Portnummer
+    output_file = argv[optind + 2];           // Name der Ausgabedatei, geöffnet wird erst beim HELLO
+
+    // Ausgabe auf stdout: die Daten bekommen den ursprünglichen stdout, alle Meldungen gehen nach stderr
+    if (strcmp(output_file, "-") == 0) {
+        if (worker_count > 0 || separate_files) {
+            printf("Output to stdout cannot be combined with -t or -m.\n");
+            exit(EXIT_FAILURE);
+        }
+        stream_fd = dup(STDOUT_FILENO);
+        if (stream_fd < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+            perror("dup");
+            exit(EXIT_FAILURE);
+        }
+        raw_output = true;
+    }
+
+    // Zieladresse für NACKs an die Gruppe
+    memset(&group_addr, 0, sizeof(group_addr));
+    group_addr.sin6_family = AF_INET6;
+    group_addr.sin6_port = htons(listen_port);
+    if (inet_pton(AF_INET6, multicast_group, &group_addr.sin6_addr) <= 0) {
+        perror("inet_pton");
+        exit(EXIT_FAILURE);
+    }
+    srand((unsigned int)(nowMicros() ^ getpid()));  // Zufällige NACK-Wartezeiten je Empfänger
+
+    if (worker_count == 0) {
+        // Ein Thread: Empfang, Umordnung und Schreiben der Ausgabe in der Hauptschleife
+        int sock = createReceiverSocket(multicast_group, listen_port);
+        initBatches(true);
+        runEventLoop(sock);
+
+        printf("Shutting down server...\n");
+
+        // Offene Sitzungen beenden: Ausgabedateien schließen und Puffer freigeben
+        closeAllSessions();
+
+        // Schließen des Sockets
+        freeBatches();
+        close(sock);
+        return 0;
+    }
+
+    // Worker-Modus: ein Schreib-Thread und worker_count Worker; der Hauptthread empfängt und verteilt
+    printf("Starting %d worker threads.\n", worker_count);
+    write_queues = calloc(worker_count, sizeof(struct write_queue));
+    dispatch_queues = calloc(worker_count, sizeof(struct dispatch_queue));
+    writer_event_fd = eventfd(0, 0);
+    if (!write_queues || !dispatch_queues || writer_event_fd < 0) {
+        perror("calloc/eventfd");
+        exit(EXIT_FAILURE);
+    }
+    for (int w = 0; w < worker_count; w++) {
+        dispatch_queues[w].event_fd = eventfd(0, EFD_NONBLOCK);
+        if (dispatch_queues[w].event_fd < 0) {
+            perror("eventfd");
+            exit(EXIT_FAILURE);
+        }
     }
+
+    // Der Socket muss vor den Workern stehen, da diese die Puffergröße (UDP GRO) übernehmen
+    int sock = createReceiverSocket(multicast_group, listen_port);
+    dispatching = true;
+    initBatches(true);
+
+    pthread_t writer;
+    pthread_t workers[MAX_WORKERS];
+    if (pthread_create(&writer, NULL, writerThread, NULL) != 0) {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+    for (int w = 0; w < worker_count; w++) {
+        if (pthread_create(&workers[w], NULL, workerThread, (void *)(intptr_t)w) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    runEventLoop(sock);
+
+    // Worker beenden; sie geben dabei die Puffer des Verteilers zurück, daher wird der Pool erst danach freigegeben
+    atomic_store(&dispatch_stop, true);
+    for (int w = 0; w < worker_count; w++) {
+        uint64_t signal = 1;
+        if (write(dispatch_queues[w].event_fd, &signal, sizeof(signal)) < 0) {
+            perror("write (eventfd)");
+        }
+    }
+    for (int w = 0; w < worker_count; w++) {
+        pthread_join(workers[w], NULL);
     }
 
     printf("Shutting down server...\n");
 
-    // Schließen des Sockets
-    close(sock);
-    return 0;
+    // Schreib-Thread erst beenden, wenn alle Aufträge der Worker erledigt sind
+    atomic_store(&writer_stop, true);
+    uint64_t signal = 1;
+    if (write(writer_event_fd, &signal, sizeof(signal)) < 0) {
+        perror("write (eventfd)");
     }
+    pthread_join(writer, NULL);
 
+    freeBatches();
+    close(sock);
+    for (int w = 0; w < worker_count; w++) {
+        close(dispatch_queues[w].event_fd);
+    }
+    close(writer_event_fd);
+    free(dispatch_queues);
+    free(write_queues);
+    return 0;
+}
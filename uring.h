@@ -0,0 +1,227 @@
+/* uring.h */
+#ifndef URING_H
+#define URING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+
+// Schlanke Anbindung an io_uring über die Systemaufrufe, ohne liburing.
+// Submission- und Completion-Queue liegen im mit dem Kernel geteilten Speicher; Köpfe und Enden
+// werden mit Acquire/Release-Zugriffen gelesen bzw. geschrieben.
+struct uring {
+    int fd;                               // Dateideskriptor des Rings
+    unsigned *sq_head;                    // Vom Kernel verbrauchte Einträge der Submission-Queue
+    unsigned *sq_tail;                    // Von uns bereitgestellte Einträge der Submission-Queue
+    unsigned *sq_array;                   // Indirektion von Position auf SQE-Index
+    unsigned sq_mask;                     // Maske für Positionen der Submission-Queue
+    struct io_uring_sqe *sqes;            // Submission-Queue-Einträge
+    unsigned *cq_head;                    // Von uns verarbeitete Einträge der Completion-Queue
+    unsigned *cq_tail;                    // Vom Kernel geschriebene Einträge der Completion-Queue
+    unsigned cq_mask;                     // Maske für Positionen der Completion-Queue
+    struct io_uring_cqe *cqes;            // Completion-Queue-Einträge
+    unsigned to_submit;                   // Bereitgestellte, noch nicht mit io_uring_enter() übergebene SQEs
+    void *sq_ring;                        // Eingeblendeter Bereich der Submission-Queue
+    size_t sq_ring_size;
+    void *cq_ring;                        // Eingeblendeter Bereich der Completion-Queue (ggf. identisch)
+    size_t cq_ring_size;
+    size_t sqes_size;
+};
+
+// Ring mit bereitgestellten Empfangspuffern (IORING_REGISTER_PBUF_RING): der Kernel wählt für jeden
+// Empfang selbst einen freien Puffer, wir geben ihn (oder einen Ersatz) nach der Verarbeitung zurück.
+// Der Speicher der Puffer gehört dem Aufrufer.
+struct uring_buffers {
+    struct io_uring_buf_ring *ring;       // Mit dem Kernel geteilter Ring der freien Puffer
+    size_t ring_size;                     // Größe des eingeblendeten Rings
+    unsigned entries;                     // Anzahl der Puffer (Zweierpotenz)
+    unsigned short tail;                  // Nächste freie Position im Ring
+    unsigned short group;                 // Puffergruppe, auf die sich SQEs beziehen
+    size_t size;                          // Größe eines Puffers
+};
+
+// Funktion zum Anlegen eines Rings mit entries Einträgen, gibt -1 mit gesetztem errno zurück, wenn
+// der Kernel io_uring nicht unterstützt oder es abgeschaltet ist
+static inline int uringInit(struct uring *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return -1;
+    }
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            munmap(ring->sq_ring, ring->sq_ring_size);
+            close(ring->fd);
+            return -1;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_ring != ring->sq_ring) {
+            munmap(ring->cq_ring, ring->cq_ring_size);
+        }
+        munmap(ring->sq_ring, ring->sq_ring_size);
+        close(ring->fd);
+        return -1;
+    }
+
+    char *sq = ring->sq_ring;
+    char *cq = ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return 0;
+}
+
+// Funktion zum Freigeben eines Rings
+static inline void uringExit(struct uring *ring) {
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fd);
+}
+
+// Funktion zum Übergeben aller bereitgestellten SQEs und Warten auf mindestens wait_nr Abschlüsse,
+// höchstens timeout Mikrosekunden (negativ: ohne Zeitlimit). Gibt -errno zurück, -ETIME bei Zeitablauf.
+static inline int uringSubmitAndWait(struct uring *ring, unsigned wait_nr, long long timeout) {
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    void *argp = NULL;
+    size_t argsz = 0;
+
+    if (wait_nr > 0 && timeout >= 0) {
+        ts.tv_sec = timeout / 1000000;
+        ts.tv_nsec = (timeout % 1000000) * 1000;
+        memset(&arg, 0, sizeof(arg));
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+
+    int ret = (int)syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait_nr, flags, argp, argsz);
+    if (ret < 0) {
+        return -errno;
+    }
+    ring->to_submit -= (unsigned)ret < ring->to_submit ? (unsigned)ret : ring->to_submit;
+    return ret;
+}
+
+// Funktion zum Holen eines freien SQE; ist die Submission-Queue voll, wird sie zuerst übergeben
+static inline struct io_uring_sqe *uringGetSqe(struct uring *ring) {
+    unsigned tail = *ring->sq_tail;
+    while (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) > ring->sq_mask) {
+        if (uringSubmitAndWait(ring, 0, -1) < 0) {
+            return NULL;
+        }
+    }
+
+    unsigned index = tail & ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->to_submit++;
+    return sqe;
+}
+
+// Funktion zum Lesen des nächsten Abschlusses, NULL wenn keiner vorliegt
+static inline struct io_uring_cqe *uringPeekCqe(struct uring *ring) {
+    unsigned head = *ring->cq_head;
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return &ring->cqes[head & ring->cq_mask];
+}
+
+// Funktion zum Freigeben des zuletzt gelesenen Abschlusses
+static inline void uringCqeSeen(struct uring *ring) {
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+// Funktion zum Bereitstellen des Puffers addr unter der Nummer bid für den nächsten Empfang
+static inline void uringProvideBuffer(struct uring_buffers *buffers, unsigned short bid, void *addr) {
+    struct io_uring_buf *buf = &buffers->ring->bufs[buffers->tail & (buffers->entries - 1)];
+    buf->addr = (uint64_t)(uintptr_t)addr;
+    buf->len = (uint32_t)buffers->size;
+    buf->bid = bid;
+    buffers->tail++;
+    __atomic_store_n(&buffers->ring->tail, buffers->tail, __ATOMIC_RELEASE);
+}
+
+// Funktion zum Registrieren eines Rings für entries Empfangspuffer zu je size Bytes als Puffergruppe group.
+// Die Puffer selbst werden danach mit uringProvideBuffer() bereitgestellt.
+// Gibt -1 mit gesetztem errno zurück (z. B. EINVAL auf Kerneln vor 5.19).
+static inline int uringSetupBuffers(struct uring *ring, struct uring_buffers *buffers, unsigned entries,
+                                    size_t size, unsigned short group) {
+    memset(buffers, 0, sizeof(*buffers));
+    buffers->ring_size = entries * sizeof(struct io_uring_buf);
+    buffers->ring = mmap(NULL, buffers->ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffers->ring == MAP_FAILED) {
+        return -1;
+    }
+    buffers->entries = entries;
+    buffers->size = size;
+    buffers->group = group;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)buffers->ring;
+    reg.ring_entries = entries;
+    reg.bgid = group;
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        munmap(buffers->ring, buffers->ring_size);
+        return -1;
+    }
+    return 0;
+}
+
+// Funktion zum Freigeben des Pufferrings (abgemeldet wird er mit uringExit())
+static inline void uringFreeBuffers(struct uring_buffers *buffers) {
+    munmap(buffers->ring, buffers->ring_size);
+}
+
+#endif